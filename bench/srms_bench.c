@@ -0,0 +1,527 @@
+/*
+ bench/srms_bench.c
+ Microbenchmarks behind the figures quoted in the commit log. The program's
+ own code is compiled in (its main is renamed), so each case times the real
+ functions. Every case checks its results against a reference before timing.
+
+   gcc -O2 -pthread -o srms_bench bench/srms_bench.c
+   ./srms_bench <case> [args]     (no case lists them)
+*/
+
+#define main srms_main
+#include "../srms.c"
+#undef main
+
+/* ---- Shared helpers ---- */
+static void bench_rate(const char *label, int n, double secs) {
+    printf("  %-22s %9.1f ms  %6.2f Mrec/s\n", label, secs * 1e3, secs > 0 ? n / secs / 1e6 : 0.0);
+}
+
+/* Fill the resident table with n random students (unique rolls). */
+static int bench_fill_table(int n, unsigned seed) {
+    table_unload();
+    if (!table_reserve(n)) return 0;
+    srand(seed);
+    for (int i = 0; i < n; ++i) {
+        Student s;
+        memset(&s, 0, sizeof(s));
+        s.roll = i;
+        snprintf(s.name, MAX_NAME, "Student %d", rand() % 100000);
+        for (int j = 0; j < SUBJECTS; ++j) s.marks[j] = (float)(rand() % 10001) / 100.0f;
+        calculate_student(&s);
+        if (!table_insert(&s)) return 0;
+    }
+    return 1;
+}
+
+/* ---- parse: one store line into a Student ---- */
+/* parse_line_to_student as it was before the in-place parser */
+static int legacy_parse_line(const char *line, Student *s) {
+    if (!line || !s) return 0;
+    char *copy = malloc(strlen(line) + 1);
+    if (!copy) return 0;
+    strcpy(copy, line);
+    size_t len = strlen(copy);
+    if (len && copy[len - 1] == '\n') copy[len - 1] = '\0';
+    char *tok = strtok(copy, "|");
+    if (!tok) { free(copy); return 0; }
+    s->roll = atoi(tok);
+    tok = strtok(NULL, "|");
+    if (!tok) { free(copy); return 0; }
+    strncpy(s->name, tok, MAX_NAME - 1);
+    s->name[MAX_NAME - 1] = '\0';
+    for (int i = 0; i < SUBJECTS; ++i) {
+        tok = strtok(NULL, "|");
+        s->marks[i] = tok ? (float)atof(tok) : 0.0f;
+    }
+    calculate_student(s);
+    free(copy);
+    return 1;
+}
+
+static int bench_parse(int argc, char **argv) {
+    int n = argc > 0 ? atoi(argv[0]) : 1000000;
+    if (n <= 0) return 2;
+    char (*lines)[64] = malloc((size_t)n * sizeof(*lines));
+    if (!lines) return 1;
+    srand(1);
+    for (int i = 0; i < n; ++i) {
+        if (i % 1000 == 0) /* odd spellings the decoder must still agree on */
+            snprintf(lines[i], sizeof(lines[i]), "  -%d||x y|1e1|inf|%d.125\n", i, i % 100);
+        else
+            snprintf(lines[i], sizeof(lines[i]), "%d|Name%d|%.2f|%.2f|%.2f\n", rand() - RAND_MAX / 2, i,
+                     rand() % 10001 / 100.0, rand() % 10001 / 100.0, (rand() % 1000) / 7.0);
+    }
+    int bad = 0;
+    for (int i = 0; i < n; ++i) {
+        Student a, b;
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        int ra = legacy_parse_line(lines[i], &a), rb = parse_line_to_student(lines[i], &b);
+        if (ra != rb || a.roll != b.roll || strcmp(a.name, b.name) || memcmp(a.marks, b.marks, sizeof(a.marks))) bad++;
+    }
+    Student s;
+    double t = now_seconds();
+    for (int i = 0; i < n; ++i) legacy_parse_line(lines[i], &s);
+    double told = now_seconds() - t;
+    t = now_seconds();
+    for (int i = 0; i < n; ++i) parse_line_to_student(lines[i], &s);
+    double tnew = now_seconds() - t;
+    printf("parse: %d lines, %d mismatches against strtok/atof\n", n, bad);
+    bench_rate("strtok/atof", n, told);
+    bench_rate("in place", n, tnew);
+    free(lines);
+    return bad != 0;
+}
+
+/* ---- load: students.txt into the table block ---- */
+/* Writes a generated STUDENT_FILE in the current directory (refusing to touch
+   an existing one) and loads it with worker_threads() workers; sweep with
+   SRMS_THREADS. Scaling needs as many free cores as threads. */
+static int bench_load(int argc, char **argv) {
+    int n = argc > 0 ? atoi(argv[0]) : 2000000;
+    if (n <= 0) return 2;
+    FILE *f = fopen(STUDENT_FILE, "r");
+    if (f) { fclose(f); printf("load: %s exists; run in an empty directory\n", STUDENT_FILE); return 1; }
+    f = fopen(STUDENT_FILE, "w");
+    if (!f) return 1;
+    srand(2);
+    for (int i = 0; i < n; ++i)
+        fprintf(f, "%d|Student %d|%.2f|%.2f|%.2f\n", i, rand() % 100000,
+                rand() % 10001 / 100.0, rand() % 10001 / 100.0, rand() % 10001 / 100.0);
+    fclose(f);
+    storageFormat = STORE_TEXT;
+    int count, bad = 0;
+    double t = now_seconds();
+    Student *arr = load_students(&count, NULL);
+    double secs = now_seconds() - t;
+    FILE *check = fopen(STUDENT_FILE, "r");
+    char line[256];
+    for (int i = 0; arr && check && fgets(line, sizeof(line), check); ++i) {
+        Student s;
+        if (i >= count || !parse_line_to_student(line, &s) || s.roll != arr[i].roll
+            || strcmp(s.name, arr[i].name) || memcmp(s.marks, arr[i].marks, sizeof(s.marks))) bad++;
+    }
+    if (check) fclose(check);
+    remove(STUDENT_FILE);
+    if (!arr) return 1;
+    printf("load: %d lines, %d threads, %d mismatches against line-by-line parsing\n", n, worker_threads(), bad + (count != n));
+    bench_rate("load_students", count, secs);
+    free(arr);
+    return bad != 0 || count != n;
+}
+
+/* ---- search: case-insensitive substring kernels ---- */
+/* contains_case_insensitive as it was before the vector kernels */
+static int legacy_contains(const char *hay, const char *needle) {
+    if (!hay || !needle) return 0;
+    size_t hn = strlen(hay), nn = strlen(needle);
+    if (nn == 0) return 1;
+    for (size_t i = 0; i + nn <= hn; ++i) {
+        size_t j;
+        for (j = 0; j < nn; ++j)
+            if (tolower((unsigned char)hay[i + j]) != tolower((unsigned char)needle[j])) break;
+        if (j == nn) return 1;
+    }
+    return 0;
+}
+
+typedef struct {
+    const char *name;
+    SubstrKernel fn;  /* NULL: legacy_contains */
+} SearchKernel;
+
+static int search_kernels(SearchKernel *out) {
+    int n = 0;
+    out[n++] = (SearchKernel){"old", NULL};
+    out[n++] = (SearchKernel){"scalar", contains_ci_scalar};
+#if SIMD_X86
+    __builtin_cpu_init();
+    out[n++] = (SearchKernel){"sse2", contains_ci_sse2};
+    if (__builtin_cpu_supports("avx2")) out[n++] = (SearchKernel){"avx2", contains_ci_avx2};
+#endif
+    return n;
+}
+
+static int search_with(const SearchKernel *k, const char *hay, const char *needle) {
+    if (!k->fn) return legacy_contains(hay, needle);
+    substrKernel = k->fn;
+    return contains_case_insensitive(hay, needle);
+}
+
+/* Total time of reps passes of every needle over nhay haystacks, per kernel. */
+static void search_table(const char *title, const SearchKernel *ks, int nk, char **hay, int nhay, int reps,
+                         const char **needles, int nneedles) {
+    printf("%-20s", title);
+    for (int k = 0; k < nk; ++k) printf(" %9s", ks[k].name);
+    printf("\n");
+    for (int q = 0; q < nneedles; ++q) {
+        printf("%-20s", needles[q]);
+        int want = -1;
+        for (int k = 0; k < nk; ++k) {
+            int hits = 0;
+            double t = now_seconds();
+            for (int r = 0; r < reps; ++r)
+                for (int i = 0; i < nhay; ++i) hits += search_with(&ks[k], hay[i], needles[q]);
+            printf(" %7.2fms%s", (now_seconds() - t) * 1e3, want >= 0 && hits != want ? "!" : "");
+            if (want < 0) want = hits;
+        }
+        printf("\n");
+    }
+}
+
+static int search_fuzz(const SearchKernel *ks, int nk, int rounds) {
+    static const char alphabet[] = "aAbB Zz@[`{\x80\xc1";
+    int m = (int)sizeof(alphabet) - 1, bad = 0;
+    char h[300], nd[140];
+    srand(3);
+    for (int it = 0; it < rounds; ++it) {
+        int hl = rand() % 260, nl = 1 + rand() % (it % 7 == 0 ? 135 : 6);
+        for (int i = 0; i < hl; ++i) h[i] = alphabet[rand() % m];
+        h[hl] = '\0';
+        if (rand() % 3 == 0 && hl > 0) { /* a case-flipped piece of the haystack */
+            int st = rand() % hl, l = rand() % (hl - st) + 1;
+            if (l > 138) l = 138;
+            for (int i = 0; i < l; ++i) nd[i] = rand() % 2 ? (char)toupper((unsigned char)h[st + i]) : h[st + i];
+            nl = l;
+        } else {
+            for (int i = 0; i < nl; ++i) nd[i] = alphabet[rand() % m];
+        }
+        nd[nl] = '\0';
+        int want = legacy_contains(h, nd);
+        for (int k = 1; k < nk; ++k) bad += search_with(&ks[k], h, nd) != want;
+    }
+    return bad;
+}
+
+static int bench_search(int argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    static const char *first[] = {"Aarav", "Priya", "Rahul", "Sneha", "Vikram", "Ananya", "Rohan", "Kavya",
+                                  "Arjun", "Meera", "John", "Mary", "Suhaas", "Lakshmi", "Oliver"};
+    static const char *last[] = {"Sharma", "Patel", "Reddy", "Iyer", "Nair", "Gupta", "Singh",
+                                 "Kumar", "Das", "Smith", "Johnson", "Rao", "Menon", "Bose"};
+    static const char *nameNeedles[] = {"q", "menon", "johnson 12345", "lakshmi menon 9999"};
+    static const char *textNeedles[] = {"zzz", "abcdefghijklmnop"};
+    SearchKernel ks[4];
+    int nk = search_kernels(ks);
+    int bad = search_fuzz(ks, nk, 300000);
+    printf("search: 300000 random pairs, %d kernel mismatches against the old loop\n", bad);
+
+    enum { NAMES = 8192, TEXT = 1 << 20 };
+    char **names = malloc(NAMES * sizeof(char *));
+    char *text = malloc(TEXT);
+    if (!names || !text) return 1;
+    for (int i = 0; i < NAMES; ++i) {
+        names[i] = malloc(MAX_NAME);
+        if (!names[i]) return 1;
+        snprintf(names[i], MAX_NAME, "%s %s %d", first[rand() % 15], last[rand() % 14], rand() % 100000);
+    }
+    for (int i = 0; i < TEXT - 1; ++i) text[i] = "abcdefghij KLMNOP"[rand() % 17];
+    text[TEXT - 1] = '\0';
+    search_table("8k names x125", ks, nk, names, NAMES, 125, nameNeedles, 4);
+    search_table("1MB text", ks, nk, &text, 1, 1, textNeedles, 2);
+    for (int i = 0; i < NAMES; ++i) free(names[i]);
+    free(names);
+    free(text);
+    return bad != 0;
+}
+
+/* ---- columns: row-wise table vs the column store ---- */
+static int cmp_row_total_desc(const void *a, const void *b) {
+    float x = ((const Student *)a)->total, y = ((const Student *)b)->total;
+    return (x < y) - (x > y);
+}
+
+static int cmp_pos_total_desc(const void *a, const void *b) {
+    float x = cols.total[*(const int *)a], y = cols.total[*(const int *)b];
+    return (x < y) - (x > y);
+}
+
+static void columns_line(const char *label, double rows, double columns, int same) {
+    printf("  %-24s %9.1f ms %9.1f ms  %s\n", label, rows * 1e3, columns * 1e3, same ? "same" : "DIFFERENT");
+}
+
+static int bench_columns(int argc, char **argv) {
+    int n = argc > 0 ? atoi(argv[0]) : 2000000;
+    if (n <= 0 || !bench_fill_table(n, 11)) return 1;
+    cols_free();
+    double t = now_seconds();
+    if (!cols_rebuild()) return 1;
+    double tb = now_seconds() - t;
+    printf("columns: %d rows, built in %.1f ms, %.1f bytes/row vs %d in the table\n",
+           n, tb * 1e3, (double)cols_bytes() / n, (int)sizeof(Student));
+    printf("  %-24s %12s %12s\n", "pass", "table", "columns");
+    int bad = 0;
+
+    t = now_seconds();
+    double sumA = 0;
+    float maxA = -1;
+    int passA = 0;
+    for (int i = 0; i < studentCount; ++i) {
+        if (studentDead[i]) continue;
+        float v = studentTable[i].percentage;
+        sumA += v;
+        if (v > maxA) maxA = v;
+        passA += v >= 50.0f;
+    }
+    double ta = now_seconds() - t;
+    t = now_seconds();
+    double sumC = 0;
+    float maxC = -1;
+    int passC = 0;
+    for (int k = 0; k < cols.count; ++k) {
+        float v = cols.pct[k];
+        sumC += v;
+        if (v > maxC) maxC = v;
+        passC += v >= 50.0f;
+    }
+    double tc = now_seconds() - t;
+    int same = sumA == sumC && maxA == maxC && passA == passC;
+    bad += !same;
+    columns_line("stats (sum/max/pass)", ta, tc, same);
+
+    t = now_seconds();
+    int inA = 0;
+    for (int i = 0; i < studentCount; ++i)
+        inA += !studentDead[i] && studentTable[i].percentage >= 60.0f && studentTable[i].percentage <= 70.0f;
+    ta = now_seconds() - t;
+    t = now_seconds();
+    int inC = 0;
+    for (int k = 0; k < cols.count; ++k) inC += cols.pct[k] >= 60.0f && cols.pct[k] <= 70.0f;
+    tc = now_seconds() - t;
+    bad += inA != inC;
+    columns_line("percentage 60-70 count", ta, tc, inA == inC);
+
+    double subA[SUBJECTS] = {0}, subC[SUBJECTS] = {0};
+    t = now_seconds();
+    for (int i = 0; i < studentCount; ++i)
+        if (!studentDead[i])
+            for (int j = 0; j < SUBJECTS; ++j) subA[j] += studentTable[i].marks[j];
+    ta = now_seconds() - t;
+    t = now_seconds();
+    for (int j = 0; j < SUBJECTS; ++j) {
+        const float *c = cols.marks[j];
+        for (int k = 0; k < cols.count; ++k) subC[j] += c[k];
+    }
+    tc = now_seconds() - t;
+    same = memcmp(subA, subC, sizeof(subA)) == 0;
+    bad += !same;
+    columns_line("per-subject sums", ta, tc, same);
+
+    int count;
+    Student *rows = table_snapshot(&count);
+    int *perm = malloc((size_t)count * sizeof(int));
+    Student *gathered = malloc((size_t)count * sizeof(Student));
+    if (!rows || !perm || !gathered) return 1;
+    t = now_seconds();
+    qsort(rows, (size_t)count, sizeof(Student), cmp_row_total_desc);
+    ta = now_seconds() - t;
+    for (int k = 0; k < count; ++k) perm[k] = k;
+    t = now_seconds();
+    qsort(perm, (size_t)count, sizeof(int), cmp_pos_total_desc);
+    tc = now_seconds() - t;
+    t = now_seconds();
+    for (int k = 0; k < count; ++k) gathered[k] = studentTable[cols.slot[perm[k]]];
+    double tg = now_seconds() - t;
+    same = 1;
+    for (int k = 0; k < count; ++k) same &= gathered[k].total == rows[k].total;
+    bad += !same;
+    columns_line("sort by total (qsort)", ta, tc, same);
+    printf("  %-24s %12s %9.1f ms  gather of the sorted rows\n", "", "", tg * 1e3);
+    free(rows);
+    free(perm);
+    free(gathered);
+    return bad != 0;
+}
+
+/* ---- stats: class_stats kernels and threads ---- */
+static int stats_agree(const ClassStats *a, const ClassStats *b) {
+    if (a->count != b->count || a->pass != b->pass || a->pctMin != b->pctMin || a->pctMax != b->pctMax) return 0;
+    if (a->pctSum - b->pctSum > 1e-9 * b->pctSum || b->pctSum - a->pctSum > 1e-9 * b->pctSum) return 0;
+    for (int j = 0; j < SUBJECTS; ++j) {
+        if (a->min[j] != b->min[j] || a->max[j] != b->max[j]) return 0;
+        double d = a->sumSq[j] - b->sumSq[j];
+        if (d > 1e-9 * b->sumSq[j] || -d > 1e-9 * b->sumSq[j]) return 0;
+    }
+    return 1;
+}
+
+/* Threads come from SRMS_THREADS as in the program; scaling needs as many
+   free cores. */
+static int bench_stats(int argc, char **argv) {
+    int n = argc > 0 ? atoi(argv[0]) : 4000000;
+    if (n <= 0 || !bench_fill_table(n, 5)) return 1;
+    for (int i = 0; i < studentCount; i += 7) table_remove_at(i); /* leave holes like a used table */
+    if (!cols_ready()) return 1;
+    printf("stats: %d live rows, %d threads for class_stats\n", cols.count, worker_threads());
+
+    double t = now_seconds();
+    double sum = 0;
+    float lo = 101.0f, hi = -1.0f;
+    int pass = 0;
+    for (int i = 0; i < studentCount; ++i) {
+        if (studentDead[i]) continue;
+        float v = studentTable[i].percentage;
+        sum += v;
+        if (v < lo) lo = v;
+        if (v > hi) hi = v;
+        pass += v >= 50.0f;
+    }
+    printf("  %-34s %7.1f ms\n", "row loop (percentage only)", (now_seconds() - t) * 1e3);
+
+    static const struct { const char *name; StatsKernel fn; } kernels[] = {
+        {"scalar kernel (pct + subjects)", stats_scalar},
+#if SIMD_X86
+        {"sse2 kernel", stats_sse2},
+        {"avx2 kernel", stats_avx2},
+#endif
+    };
+    ClassStats ref, st;
+    stats_scalar(0, cols.count, &ref);
+    int bad = ref.pass != pass || ref.pctMin != lo || ref.pctMax != hi;
+#if SIMD_X86
+    __builtin_cpu_init();
+#endif
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+#if SIMD_X86
+        if (kernels[k].fn == stats_avx2 && !__builtin_cpu_supports("avx2")) continue;
+#endif
+        t = now_seconds();
+        kernels[k].fn(0, cols.count, &st);
+        double secs = now_seconds() - t;
+        int same = stats_agree(&st, &ref);
+        bad += !same;
+        printf("  %-34s %7.1f ms  %s\n", kernels[k].name, secs * 1e3, same ? "same" : "DIFFERENT");
+    }
+    t = now_seconds();
+    class_stats(&st);
+    double secs = now_seconds() - t;
+    stats_find_slots(&ref);
+    int same = stats_agree(&st, &ref) && st.minSlot == ref.minSlot && st.maxSlot == ref.maxSlot;
+    bad += !same;
+    printf("  %-34s %7.1f ms  %s\n", "class_stats incl. slot recovery", secs * 1e3, same ? "same" : "DIFFERENT");
+    return bad != 0;
+}
+
+/* ---- radix: roll and total orders ---- */
+static const int *radixRolls;
+static const float *radixTotals;
+
+static int cmp_perm_roll(const void *a, const void *b) {
+    int x = radixRolls[*(const int *)a], y = radixRolls[*(const int *)b];
+    return (x > y) - (x < y);
+}
+
+static int cmp_perm_total_desc(const void *a, const void *b) {
+    float x = radixTotals[*(const int *)a], y = radixTotals[*(const int *)b];
+    return (x < y) - (x > y);
+}
+
+/* Ordered by the key, and equal keys keep their original order. */
+static int radix_order_ok(const int *perm, int n, int byTotal) {
+    for (int i = 1; i < n; ++i) {
+        int a = perm[i - 1], b = perm[i];
+        int c = byTotal ? (radixTotals[a] < radixTotals[b]) - (radixTotals[a] > radixTotals[b])
+                        : (radixRolls[a] > radixRolls[b]) - (radixRolls[a] < radixRolls[b]);
+        if (c > 0 || (c == 0 && a > b)) return 0;
+    }
+    return 1;
+}
+
+/* Sizes to run, default 10k and 1M; 10M needs about 3 GB. */
+static int bench_radix(int argc, char **argv) {
+    static const char *defaults[] = {"10000", "1000000"};
+    if (argc == 0) { argc = 2; argv = (char **)defaults; }
+    int bad = 0;
+    for (int a = 0; a < argc; ++a) {
+        int n = atoi(argv[a]);
+        if (n <= 0) return 2;
+        Student *rows = malloc((size_t)n * sizeof(Student));
+        Student *copy = malloc((size_t)n * sizeof(Student));
+        int *rolls = malloc((size_t)n * sizeof(int)), *perm = malloc((size_t)n * sizeof(int));
+        float *totals = malloc((size_t)n * sizeof(float));
+        unsigned *keys = malloc((size_t)n * sizeof(unsigned));
+        if (!rows || !copy || !rolls || !perm || !totals || !keys) return 1;
+        srand(42);
+        for (int i = 0; i < n; ++i) {
+            memset(&rows[i], 0, sizeof(Student));
+            rows[i].roll = rolls[i] = (rand() % 2 ? 1 : -1) * (rand() % 2000000000);
+            rows[i].total = totals[i] = (float)(rand() % 30001) / 100.0f;
+        }
+        radixRolls = rolls;
+        radixTotals = totals;
+        for (int byTotal = 0; byTotal < 2; ++byTotal) {
+            memcpy(copy, rows, (size_t)n * sizeof(Student));
+            double t = now_seconds();
+            qsort(copy, (size_t)n, sizeof(Student), byTotal ? cmp_marks_desc : cmp_roll_asc);
+            double tRows = now_seconds() - t;
+            for (int i = 0; i < n; ++i) perm[i] = i;
+            t = now_seconds();
+            qsort(perm, (size_t)n, sizeof(int), byTotal ? cmp_perm_total_desc : cmp_perm_roll);
+            double tPerm = now_seconds() - t;
+            for (int i = 0; i < n; ++i) perm[i] = i;
+            t = now_seconds();
+            for (int i = 0; i < n; ++i) keys[i] = byTotal ? ~radix_key_float(totals[i]) : radix_key_int(rolls[i]);
+            int ok = radix_sort_perm(keys, perm, n);
+            double tRadix = now_seconds() - t;
+            ok = ok && radix_order_ok(perm, n, byTotal);
+            bad += !ok;
+            printf("radix: n=%-9d %-5s qsort(Student) %8.1f ms  qsort(perm) %8.1f ms  radix %7.1f ms  %s\n",
+                   n, byTotal ? "total" : "roll", tRows * 1e3, tPerm * 1e3, tRadix * 1e3,
+                   ok ? "ordered, stable" : "WRONG ORDER");
+        }
+        free(rows);
+        free(copy);
+        free(rolls);
+        free(perm);
+        free(totals);
+        free(keys);
+    }
+    return bad != 0;
+}
+
+/* ---- Driver ---- */
+typedef struct {
+    const char *name;
+    const char *args;
+    int (*run)(int argc, char **argv);
+} BenchCase;
+
+static const BenchCase benchCases[] = {
+    {"parse", "[lines]", bench_parse},
+    {"load", "[lines]  (SRMS_THREADS=n)", bench_load},
+    {"search", "", bench_search},
+    {"columns", "[rows]", bench_columns},
+    {"stats", "[rows]  (SRMS_THREADS=n)", bench_stats},
+    {"radix", "[rows...]", bench_radix},
+};
+
+int main(int argc, char **argv) {
+    int ncases = (int)(sizeof(benchCases) / sizeof(benchCases[0]));
+    for (int i = 0; argc > 1 && i < ncases; ++i)
+        if (strcmp(argv[1], benchCases[i].name) == 0) return benchCases[i].run(argc - 2, argv + 2);
+    printf("usage: %s <case> [args]\n", argv[0]);
+    for (int i = 0; i < ncases; ++i) printf("  %s %s\n", benchCases[i].name, benchCases[i].args);
+    return 2;
+}
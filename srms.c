@@ -1,38 +1,97 @@
 /*
  srms_fixed_portable.c
  Portable single-file SRMS (fixed & cleaned)
- Compiles on Linux/macOS (gcc/clang) and Windows (MinGW).
+ Compiles on Linux/macOS (gcc/clang, add -pthread) and Windows (MinGW).
 */
 
+/* glibc hides madvise, truncate, syscall and strnlen under strict -std=c11 */
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <time.h>
+#include <limits.h>
 
 #if defined(_WIN32) || defined(_WIN64)
   #include <conio.h>
+  #include <io.h>
+  #include <windows.h>
   #define CLEAR_CMD "cls"
   #define OS_WINDOWS 1
 #else
   #include <termios.h>
   #include <unistd.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <pthread.h>
+  #if defined(__linux__)
+    #include <sys/sendfile.h>
+    #include <sys/syscall.h>
+  #endif
   #define CLEAR_CMD "clear"
   #define OS_WINDOWS 0
 #endif
 
+/* x86 vector kernels (SSE2 baseline, AVX2 picked at runtime) on gcc/clang */
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+  #include <immintrin.h>
+  #define SIMD_X86 1
+#else
+  #define SIMD_X86 0
+#endif
+
 /* ---- Config ---- */
 #define STUDENT_FILE "students.txt"
+#define STUDENT_BIN_FILE "students.bin"
 #define CREDENTIAL_FILE "credentials.txt"
 #define BACKUP_FILE "students_backup.txt"
+#define BACKUP_BIN_FILE "students_backup.bin"
+#define BTREE_FILE "students.db"
+#define BTREE_DW_FILE "students.db.dw"
+#define BACKUP_BTREE_FILE "students_backup.db"
+#define JOURNAL_FILE "students.journal"
+#define JOURNAL_OLD_FILE "students.journal.old"
+#define STORE_FORMAT_FILE "students.fmt"
 #define REPORT_FILE "report.txt"
 #define CSV_FILE "students.csv"
 
+/* worker threads: SRMS_THREADS overrides the online CPU count */
+#define MAX_WORKERS 64
+#define PARALLEL_LOAD_MIN_BYTES (1 << 20)
+/* statistics over fewer rows stay on the calling thread */
+#define PARALLEL_STATS_MIN_ROWS (1 << 18)
+/* sorts of fewer rows stay on the calling thread */
+#define PARALLEL_SORT_MIN_ROWS (1 << 16)
+/* exports of fewer rows are formatted on the calling thread */
+#define PARALLEL_EXPORT_MIN_ROWS (1 << 16)
+
+/* fold the journal into the base store once it holds this many entries */
+#define JOURNAL_CHECKPOINT_ENTRIES 4096
+/* at exit, also fold it in once it reaches this percentage of the live rows */
+#define JOURNAL_EXIT_CHECKPOINT_PERCENT 10
+/* group commit: fsync the journal after this many entries or once
+   SRMS_COMMIT_INTERVAL seconds (default below, 0 = every entry) have passed */
+#define JOURNAL_GROUP_COMMIT 64
+#define DEFAULT_COMMIT_INTERVAL 1
+
+/* squeeze tombstoned rows out of the table once this share of it is dead */
+#define COMPACT_DEAD_PERCENT 25
+#define COMPACT_MIN_DEAD 64
+
+/* B+tree store: page size and number of clean pages kept cached */
+#define BTREE_PAGE 4096
+#define BTREE_CACHE_PAGES 256
+
 #define MAX_NAME 100
 #define MAX_USER 50
 #define MAX_ROLE 16
 #define SUBJECTS 3
 const char *subjectNames[SUBJECTS] = {"Math", "Science", "English"};
+enum { GRADE_A_PLUS, GRADE_A, GRADE_B, GRADE_C, GRADE_D, GRADE_F, GRADE_COUNT };
+const char *gradeNames[GRADE_COUNT] = {"A+", "A", "B", "C", "D", "F"};
 
 /* ---- Types ---- */
 typedef struct {
@@ -41,13 +100,285 @@ typedef struct {
     float marks[SUBJECTS];
     float total;
     float percentage;
-    char grade[4];
+    unsigned char grade;  /* GRADE_*, label in gradeNames */
 } Student;
 
+/* students.bin layout: BinHeader, count BinRecords, then heapSize bytes of
+   names. Fields are native-endian; names are not NUL-terminated. */
+#define BIN_MAGIC "SRMB"
+#define BIN_VERSION 1u
+typedef struct {
+    char magic[4];
+    unsigned version;
+    unsigned count;
+    unsigned heapSize;
+} BinHeader;
+
+typedef struct {
+    int roll;
+    float marks[SUBJECTS];
+    unsigned nameOff;
+    unsigned nameLen;
+} BinRecord;
+
+/* students.db pages (see the B+tree store section) */
+#define BT_MAGIC "SRMT"
+#define BT_VERSION 1u
+enum { BT_LEAF = 1, BT_INNER = 2 };
+typedef struct {
+    char magic[4];
+    unsigned version;
+    unsigned pageSize;
+    unsigned root;
+    unsigned height;      /* 0 when the root is a leaf */
+    unsigned pageCount;
+    unsigned recordCount;
+} BtHeader;
+
+typedef struct {
+    unsigned short type;
+    unsigned short count; /* records in a leaf, keys in an inner node */
+    unsigned next;        /* right sibling leaf, 0 at the end */
+    unsigned reserved[2];
+} BtNode;
+
+typedef struct {
+    int roll;
+    float marks[SUBJECTS];
+    char name[MAX_NAME];
+} BtRecord;
+
+#define BT_LEAF_CAP ((BTREE_PAGE - sizeof(BtNode)) / sizeof(BtRecord))
+#define BT_INNER_CAP ((BTREE_PAGE - sizeof(BtNode) - sizeof(unsigned)) / (sizeof(int) + sizeof(unsigned)))
+
+typedef struct {
+    unsigned pgno;
+    int dirty;
+    unsigned long lastUse;
+    unsigned char *data;
+} BtFrame;
+
+typedef struct {
+    FILE *fp;
+    BtHeader h;
+    BtFrame *frames;
+    int frameCount, frameCap;
+    int *pageFrame;       /* page number -> frame, -1 when not cached */
+    unsigned pageFrameCap;
+    unsigned long tick;
+} BTree;
+
+/* growable result buffer for scans */
+typedef struct {
+    Student *rows;
+    int count, cap;
+} StudentBuf;
+
+enum { STORE_TEXT, STORE_BINARY, STORE_BTREE };
+
+/* one posting list of the name index: table slots whose name holds key */
+typedef struct {
+    unsigned key;         /* three case-folded bytes | TRIGRAM_USED, 0 = empty slot */
+    int count, cap;
+    int *ids;
+} TrigramList;
+
+/* one entry of the percentage index */
+typedef struct {
+    float pct;
+    int idx;
+} PctEntry;
+
+/* live rows by column (see the column store section) */
+typedef struct {
+    int count, cap;
+    int *slot;                    /* position -> table slot */
+    int *roll;
+    float *marks[SUBJECTS];
+    float *total;
+    float *pct;
+    unsigned char *grade;
+    unsigned *nameOff;            /* into heap, NUL-terminated */
+    int *colPos;                  /* table slot -> position, posCap entries */
+    int posCap;
+    char *heap;
+    size_t heapSize, heapCap, heapGarbage;
+    int valid;
+} StudentColumns;
+
+/* class summary from class_stats() */
+typedef struct {
+    int count;
+    double pctSum;
+    float pctMin, pctMax;
+    int minSlot, maxSlot;         /* earliest table slot holding pctMin / pctMax */
+    int pass;
+    double sum[SUBJECTS], sumSq[SUBJECTS];
+    float min[SUBJECTS], max[SUBJECTS];
+} ClassStats;
+
+/* binary heap of (percentage, slot), lowest or highest first */
+typedef struct {
+    PctEntry *e;
+    int count, cap;
+    int high;
+} SlotHeap;
+
+/* class totals kept current by every mutation (see running statistics) */
+#define MARK_BUCKETS (100 * 100 + 1)
+typedef struct {
+    int valid;
+    int count, pass;
+    int gradeCount[GRADE_COUNT];
+    double pctSum;
+    float pctMin, pctMax;
+    int minSlot, maxSlot;         /* earliest table slot holding pctMin / pctMax */
+    double sum[SUBJECTS], sumSq[SUBJECTS];
+    float min[SUBJECTS], max[SUBJECTS];
+    SlotHeap pctLow, pctHigh;     /* may hold stale entries, dropped lazily */
+    int *markTree[SUBJECTS];      /* Fenwick tree of rows per 0.01 mark, 1-based */
+} RunningStats;
+
+/* compressed bitmap of table slots (see the grade bitmaps section) */
+#define BM_ARRAY_MAX 4096
+#define BM_CHUNK_WORDS 1024
+typedef struct {
+    unsigned key;                 /* slot >> 16 */
+    int card;                     /* slots set in this chunk */
+    int arrCap;
+    unsigned short *arr;          /* sorted low halves, while card <= BM_ARRAY_MAX */
+    unsigned long long *bits;     /* 65536-bit set otherwise */
+} BmChunk;
+
+typedef struct {
+    BmChunk *chunks;              /* ascending key */
+    int count, cap;
+} Bitmap;
+
+/* columns to sort by, with the keys precomputed from them (see multi-key sort) */
+#define MAX_SORT_KEYS 8
+enum { SORT_ROLL, SORT_NAME, SORT_TOTAL, SORT_PCT, SORT_GRADE, SORT_FIELD_COUNT };
+typedef struct {
+    int nkeys;
+    int field[MAX_SORT_KEYS];
+    int desc[MAX_SORT_KEYS];
+    unsigned *num[MAX_SORT_KEYS];       /* order key per column position; NULL for name */
+    unsigned long long *namePrefix;     /* first 8 folded name bytes, big-endian */
+    unsigned *nameOff;                  /* into nameHeap, NUL-terminated */
+    char *nameHeap;                     /* case-folded names */
+    int exact;                          /* the packed record key decides every tie */
+} SortPlan;
+
+/* one row being sorted: the leading sort keys packed big-endian into 16 bytes */
+typedef struct {
+    unsigned long long key[2];
+    int pos;
+} SortRec;
+
+/* one row of a top-K ranking (see ranking) */
+typedef struct {
+    float value;
+    int slot;
+} RankEntry;
+
+/* read-only view of a whole file: mmap on POSIX, a heap copy on Windows */
+typedef struct {
+    const char *data;
+    size_t size;
+    int mapped;
+} FileView;
+
 /* ---- Globals ---- */
 char currentUser[MAX_USER] = {0};
 char currentRole[MAX_ROLE] = {0};
 
+/* resident student table: loaded once at login, kept in step with every write */
+Student *studentTable = NULL;
+int studentCount = 0;
+int studentCap = 0;
+
+/* deleted rows stay in place as tombstones until the table is compacted */
+unsigned char *studentDead = NULL;
+int deadCount = 0;
+
+/* active storage format, chosen at startup from SRMS_FORMAT (text|binary|btree) */
+int storageFormat = STORE_TEXT;
+const char *storeFormatNames[] = {"text", "binary", "btree"};
+
+/* open B+tree store and its page cache */
+BTree btree;
+
+/* set when an edit reached the journal but not the tree: the next checkpoint
+   rebuilds the tree from the table instead of flushing its pages */
+int btreeStale = 0;
+
+/* entries in JOURNAL_FILE not yet folded into the base store */
+int journalEntries = 0;
+
+/* open journal handle and group-commit state, guarded by journalLock */
+FILE *journalFp = NULL;
+int journalPending = 0;
+time_t journalLastSync = 0;
+int commitInterval = DEFAULT_COMMIT_INTERVAL;
+#if !OS_WINDOWS
+pthread_mutex_t journalLock = PTHREAD_MUTEX_INITIALIZER;
+/* group-commit flusher thread; journalWake cuts its wait short to stop it */
+pthread_cond_t journalWake = PTHREAD_COND_INITIALIZER;
+pthread_t journalFlusher;
+int journalFlusherStarted = 0;
+int journalFlusherStop = 0;
+#endif
+
+/* background checkpoint: a snapshot of the live rows written off the UI thread */
+typedef struct {
+    Student *rows;
+    int count;
+    int ok;
+} CheckpointJob;
+CheckpointJob checkpointJob;
+int checkpointRunning = 0;
+int checkpointFailed = 0;
+#if !OS_WINDOWS
+pthread_t checkpointThread;
+#endif
+
+/* roll -> table slot, open addressing with linear probing (-1 = empty) */
+int *rollIndex = NULL;
+int rollIndexCap = 0;
+int rollIndexUsed = 0;
+
+/* column copy of the live rows for scans, statistics and sorting */
+StudentColumns cols;
+
+/* class totals for statistics and the dashboard */
+RunningStats runStats;
+
+/* trigram -> table slots for partial-name search, built on first use */
+TrigramList *nameIndex = NULL;
+int nameIndexCap = 0;
+int nameIndexUsed = 0;
+int nameIndexBuilt = 0;
+int nameIndexStale = 0;
+
+/* live rows ordered by (percentage, slot) for range and rank queries */
+PctEntry *pctIndex = NULL;
+int pctIndexCount = 0;
+int pctIndexCap = 0;
+int pctIndexBuilt = 0;
+
+/* live rows per 0.01 of total marks as a Fenwick tree, for class rank */
+#define RANK_BUCKETS (100 * 100 * SUBJECTS + 1)
+int *rankTree = NULL;            /* 1-based, RANK_BUCKETS entries */
+int rankTreeBuilt = 0;
+
+/* table slots of each grade, built on first use */
+Bitmap gradeBitmaps[GRADE_COUNT];
+int gradeBitmapsBuilt = 0;
+
+/* high-water mark of the table's record block plus its tombstone map, for
+   the memory report */
+size_t tablePeakBytes = 0;
+
 /* ---- Prototypes (all functions declared for clarity) ---- */
 /* utilities */
 void clear_input_line(void);
@@ -58,6 +389,8 @@ void safe_gets(char *buf, int n);
 int contains_case_insensitive(const char *hay, const char *needle);
 void get_password(char *out, int maxlen);
 void xor_file(const char *filename, const char key);
+int worker_threads(void);
+void run_workers(void *(*fn)(void *), void *args, size_t stride, int n);
 
 /* validation & student helpers */
 void calculate_student(Student *s);
@@ -65,12 +398,129 @@ int valid_name(const char *name);
 int valid_marks(float mark);
 
 /* file helpers */
+int file_view_open(const char *filename, FileView *v);
+void file_view_close(FileView *v);
+int file_sync(FILE *fp);
+FILE *open_replacement(const char *path, char *tmpPath, size_t tmpLen, const char *mode);
+int commit_replacement(FILE *fp, const char *tmpPath, const char *path);
+int truncate_file(const char *path, long length);
+double now_seconds(void);
+long long copy_file_atomic(const char *srcPath, const char *dstPath);
+void print_copy_rate(long long bytes, double seconds);
 int write_student_to_file(FILE *fp, const Student *s);
+int write_student_exact(FILE *fp, const Student *s);
 int parse_line_to_student(const char *line, Student *s);
+int parse_student_record(const char *p, const char *end, Student *s);
 Student *read_all_students(int *outCount);
+Student *load_students(int *outCount, int *outCap);
 int roll_exists(int roll);
 int append_student(const Student *s);
 int overwrite_students(Student *arr, int count);
+const char *student_store_path(void);
+const char *student_backup_path(void);
+Student *load_binary_students(const char *path, int *outCount, int *outCap);
+int write_binary_students(const char *path, const Student *arr, int count);
+void storage_init(void);
+int write_store_format(int fmt);
+
+/* B+tree store */
+int btree_build(const char *path, const Student *arr, int count);
+void btree_close(void);
+int btree_insert(const Student *s);
+int btree_update(const Student *s);
+int btree_delete(int roll);
+int btree_lookup(int roll, Student *out);
+int btree_scan(int lo, int hi, void (*fn)(const Student *, void *), void *ctx);
+int btree_flush(void);
+Student *load_btree_students(int *outCount, int *outCap);
+
+/* journal */
+int journal_append(char op, const Student *s, int roll);
+int store_update(const Student *s);
+int store_delete(int roll);
+int journal_replay(void);
+int journal_reset(void);
+int journal_sync(void);
+void journal_close(void);
+int store_checkpoint(void);
+int store_checkpoint_async(void);
+void store_checkpoint_wait(void);
+int store_maybe_checkpoint(void);
+int store_flush(void);
+void store_close(void);
+
+/* resident table */
+int table_load(void);
+void table_unload(void);
+int table_reserve(int need);
+int table_find_roll(int roll);
+int table_insert(const Student *s);
+void table_update_at(int idx, const Student *s);
+void table_remove_at(int idx);
+void table_rebuild_indexes(void);
+int table_live_count(void);
+void table_compact(void);
+void table_maybe_compact(void);
+Student *table_snapshot(int *outCount);
+
+/* roll index */
+int roll_index_rebuild(void);
+int roll_index_put(int roll, int idx);
+int roll_index_get(int roll);
+void roll_index_remove(int roll);
+
+/* column store */
+int cols_rebuild(void);
+int cols_ready(void);
+void cols_free(void);
+void cols_append(int idx);
+void cols_update(int idx);
+void cols_remove(int idx);
+const char *col_name(int pos);
+size_t cols_bytes(void);
+int class_stats(ClassStats *out);
+
+/* running statistics */
+void running_stats_add(int idx);
+void running_stats_remove(int idx);
+int running_stats_rebuild(void);
+int running_stats_ready(void);
+void running_stats_free(void);
+int pct_extremes(int *minIdx, int *maxIdx);
+void print_dashboard(void);
+
+/* name index */
+int name_index_rebuild(void);
+void name_index_drop(void);
+void name_index_add(int idx, const char *oldName);
+void name_index_forget(void);
+int name_index_search(const char *q, int **out);
+
+/* percentage index */
+int pct_index_rebuild(void);
+void pct_index_drop(void);
+void pct_index_add(int idx);
+void pct_index_remove(int idx, float pct);
+int pct_index_range(float lo, float hi, int *first);
+
+/* class rank */
+int rank_tree_rebuild(void);
+void rank_tree_drop(void);
+void rank_tree_add(float total, int delta);
+int class_rank(int idx, int *rank, int *below);
+void print_class_rank(int idx);
+
+/* slot bitmaps and grade filters */
+int bm_set(Bitmap *b, int slot);
+void bm_clear(Bitmap *b, int slot);
+void bm_free(Bitmap *b);
+int bm_combine(const Bitmap *x, const Bitmap *y, Bitmap *out, int isAnd);
+int bm_slots(const Bitmap *b, int **out);
+int grade_bitmaps_rebuild(void);
+void grade_bitmaps_drop(void);
+void grade_bitmaps_set(int idx, int grade, int on);
+int grade_from_label(const char *label);
+int filter_eval(const char *expr, Bitmap *out);
 
 /* credentials */
 int check_credentials(const char *username, const char *password, char *outRole);
@@ -84,16 +534,27 @@ void feature_add_student(void);
 int display_students_table(Student *arr, int count);
 void feature_display_all(void);
 void feature_search(void);
+int cmp_roll_asc(const void *a, const void *b);
+unsigned radix_key_int(int v);
+unsigned radix_key_float(float v);
+int radix_sort_perm(unsigned *keys, int *perm, int n);
+int sort_plan_parse(const char *spec, SortPlan *plan);
+int sort_plan_prepare(SortPlan *plan);
+void sort_plan_free(SortPlan *plan);
+int multi_sort(const SortPlan *plan, int *perm, int n);
 void feature_update_student(void);
 void feature_delete_student(void);
 void feature_delete_all(void);
 void feature_sorting(void);
+int rank_top_k(int subject, int bottom, int k, RankEntry *out);
+void feature_ranking(void);
 void feature_statistics(void);
 void feature_export(void);
 void feature_backup(void);
 void feature_restore(void);
 void feature_manage_credentials(void);
 void feature_toggle_encryption(void);
+void feature_convert_storage(void);
 
 /* menus */
 void admin_menu(void);
@@ -142,21 +603,129 @@ void safe_gets(char *buf, int n) {
     buf[strcspn(buf, "\n")] = '\0';
 }
 
-/* case-insensitive substring check (portable) */
+/* ---- Case-insensitive substring search ---- */
+/* contains_case_insensitive() folds ASCII letters like tolower() in the C
+   locale. The vector kernels compare the needle's first and last bytes
+   against 16 or 32 haystack positions at once and only check the middle of
+   the needle where both match. The kernel is picked once from the CPU. */
+static int fold_ascii(int c) {
+    return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+/* Does hay[0..n) equal the already folded needle f[0..n) ignoring case? */
+static int folded_equal(const char *hay, const char *f, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (fold_ascii((unsigned char)hay[i]) != (unsigned char)f[i]) return 0;
+    return 1;
+}
+
+/* The original nested loop, kept for CPUs without SSE2 and as the reference. */
+static int contains_ci_scalar(const char *hay, size_t hn, const char *f, size_t nn) {
+    for (size_t i = 0; i + nn <= hn; ++i)
+        if (fold_ascii((unsigned char)hay[i]) == (unsigned char)f[0] && folded_equal(hay + i + 1, f + 1, nn - 1)) return 1;
+    return 0;
+}
+
+/* Needles longer than this use the scalar loop (the tail buffer is fixed). */
+#define SIMD_MAX_NEEDLE 128
+
+#if SIMD_X86
+static int lowest_bit(unsigned m) {
+    return __builtin_ctz(m);
+}
+
+static __m128i fold16(__m128i x) {
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/* Candidates at p[0..16) limited by keep; p must be readable for 15 + nn bytes. */
+static int sse2_block(const char *p, const char *f, size_t nn, unsigned keep) {
+    __m128i a = fold16(_mm_loadu_si128((const __m128i *)p));
+    __m128i b = fold16(_mm_loadu_si128((const __m128i *)(p + nn - 1)));
+    __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(a, _mm_set1_epi8(f[0])), _mm_cmpeq_epi8(b, _mm_set1_epi8(f[nn - 1])));
+    unsigned m = (unsigned)_mm_movemask_epi8(hit) & keep;
+    while (m) {
+        int bit = lowest_bit(m);
+        if (nn <= 2 || folded_equal(p + bit + 1, f + 1, nn - 2)) return 1;
+        m &= m - 1;
+    }
+    return 0;
+}
+
+static int contains_ci_sse2(const char *hay, size_t hn, const char *f, size_t nn) {
+    size_t i = 0;
+    for (; i + 16 + nn - 1 <= hn; i += 16)
+        if (sse2_block(hay + i, f, nn, 0xffffu)) return 1;
+    /* fewer than 16 start positions left: run one block over a zero-padded copy */
+    size_t r = hn - i;
+    if (r < nn) return 0;
+    char pad[16 + SIMD_MAX_NEEDLE + 16];
+    memcpy(pad, hay + i, r);
+    memset(pad + r, 0, 16 - 1 + nn - r);
+    return sse2_block(pad, f, nn, (1u << (r - nn + 1)) - 1);
+}
+
+__attribute__((target("avx2")))
+static __m256i fold32(__m256i x) {
+    __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), x));
+    return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+static int avx2_block(const char *p, const char *f, size_t nn, unsigned keep) {
+    __m256i a = fold32(_mm256_loadu_si256((const __m256i *)p));
+    __m256i b = fold32(_mm256_loadu_si256((const __m256i *)(p + nn - 1)));
+    __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(a, _mm256_set1_epi8(f[0])), _mm256_cmpeq_epi8(b, _mm256_set1_epi8(f[nn - 1])));
+    unsigned m = (unsigned)_mm256_movemask_epi8(hit) & keep;
+    while (m) {
+        int bit = lowest_bit(m);
+        if (nn <= 2 || folded_equal(p + bit + 1, f + 1, nn - 2)) return 1;
+        m &= m - 1;
+    }
+    return 0;
+}
+
+__attribute__((target("avx2")))
+static int contains_ci_avx2(const char *hay, size_t hn, const char *f, size_t nn) {
+    size_t i = 0;
+    for (; i + 32 + nn - 1 <= hn; i += 32)
+        if (avx2_block(hay + i, f, nn, 0xffffffffu)) return 1;
+    size_t r = hn - i;
+    if (r < nn) return 0;
+    char pad[32 + SIMD_MAX_NEEDLE + 32];
+    memcpy(pad, hay + i, r);
+    memset(pad + r, 0, 32 - 1 + nn - r);
+    return avx2_block(pad, f, nn, (1u << (r - nn + 1)) - 1);
+}
+#endif
+
+typedef int (*SubstrKernel)(const char *hay, size_t hn, const char *f, size_t nn);
+static SubstrKernel substrKernel = NULL;
+
+static SubstrKernel pick_substr_kernel(void) {
+#if SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return contains_ci_avx2;
+    return contains_ci_sse2;
+#else
+    return contains_ci_scalar;
+#endif
+}
+
 int contains_case_insensitive(const char *hay, const char *needle) {
     if (!hay || !needle) return 0;
     size_t hn = strlen(hay), nn = strlen(needle);
     if (nn == 0) return 1;
-    for (size_t i = 0; i + nn <= hn; ++i) {
-        size_t j;
-        for (j = 0; j < nn; ++j) {
-            char a = tolower((unsigned char)hay[i + j]);
-            char b = tolower((unsigned char)needle[j]);
-            if (a != b) break;
-        }
-        if (j == nn) return 1;
-    }
-    return 0;
+    if (nn > hn) return 0;
+    char buf[SIMD_MAX_NEEDLE];
+    char *f = nn <= sizeof(buf) ? buf : malloc(nn);
+    if (!f) return 0;
+    for (size_t j = 0; j < nn; ++j) f[j] = (char)fold_ascii((unsigned char)needle[j]);
+    if (!substrKernel) substrKernel = pick_substr_kernel();
+    int found = nn <= sizeof(buf) ? substrKernel(hay, hn, f, nn) : contains_ci_scalar(hay, hn, f, nn);
+    if (f != buf) free(f);
+    return found;
 }
 
 /* portable strcasecmp fallback */
@@ -202,126 +771,2891 @@ void get_password(char *out, int maxlen) {
 #endif
 }
 
-/* XOR transform for a file (simple demo encryption) */
-void xor_file(const char *filename, const char key) {
-    FILE *f = fopen(filename, "rb+");
-    if (!f) return;
-    unsigned char buf[4096];
-    size_t n;
-    long pos = 0;
-    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
-        for (size_t i = 0; i < n; ++i) buf[i] ^= (unsigned char)key;
-        fseek(f, pos, SEEK_SET);
-        fwrite(buf, 1, n, f);
-        pos = ftell(f);
-        fseek(f, pos, SEEK_SET);
-    }
-    fclose(f);
+/* XOR transform for a file (simple demo encryption) */
+void xor_file(const char *filename, const char key) {
+    FILE *f = fopen(filename, "rb+");
+    if (!f) return;
+    unsigned char buf[4096];
+    size_t n;
+    long pos = 0;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (size_t i = 0; i < n; ++i) buf[i] ^= (unsigned char)key;
+        fseek(f, pos, SEEK_SET);
+        fwrite(buf, 1, n, f);
+        pos = ftell(f);
+        fseek(f, pos, SEEK_SET);
+    }
+    fclose(f);
+}
+
+/* Number of worker threads to use, from SRMS_THREADS or the CPU count. */
+int worker_threads(void) {
+    static int cached = 0;
+    if (cached) return cached;
+    int n = 0;
+    const char *env = getenv("SRMS_THREADS");
+    if (env) n = atoi(env);
+#if !OS_WINDOWS
+    if (n <= 0) n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n <= 0) n = 1;
+    if (n > MAX_WORKERS) n = MAX_WORKERS;
+    cached = n;
+    return cached;
+}
+
+/* Run fn on n argument blocks laid out stride bytes apart, one thread each, and
+   wait for all of them. Windows builds (and failed thread starts) run inline. */
+void run_workers(void *(*fn)(void *), void *args, size_t stride, int n) {
+    char *base = args;
+#if OS_WINDOWS
+    for (int i = 0; i < n; ++i) fn(base + (size_t)i * stride);
+#else
+    pthread_t tids[MAX_WORKERS];
+    int started[MAX_WORKERS] = {0};
+    if (n > MAX_WORKERS) n = MAX_WORKERS;
+    for (int i = 1; i < n; ++i)
+        started[i] = pthread_create(&tids[i], NULL, fn, base + (size_t)i * stride) == 0;
+    if (n > 0) fn(base);
+    for (int i = 1; i < n; ++i) {
+        if (started[i]) pthread_join(tids[i], NULL);
+        else fn(base + (size_t)i * stride);
+    }
+#endif
+}
+
+/* ---- Student scoring & validation ---- */
+void calculate_student(Student *s) {
+    s->total = 0.0f;
+    for (int i = 0; i < SUBJECTS; ++i) s->total += s->marks[i];
+    s->percentage = (s->total / (100.0f * SUBJECTS)) * 100.0f;
+    if (s->percentage >= 90.0f) s->grade = GRADE_A_PLUS;
+    else if (s->percentage >= 80.0f) s->grade = GRADE_A;
+    else if (s->percentage >= 70.0f) s->grade = GRADE_B;
+    else if (s->percentage >= 60.0f) s->grade = GRADE_C;
+    else if (s->percentage >= 50.0f) s->grade = GRADE_D;
+    else s->grade = GRADE_F;
+}
+
+int valid_name(const char *name) {
+    return name && name[0] != '\0';
+}
+
+int valid_marks(float mark) {
+    return (mark >= 0.0f && mark <= 100.0f);
+}
+
+/* ---- File helpers ---- */
+int file_view_open(const char *filename, FileView *v) {
+    v->data = NULL; v->size = 0; v->mapped = 0;
+#if OS_WINDOWS
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) return 0;
+    long size = 0;
+    if (fseek(fp, 0, SEEK_END) == 0) size = ftell(fp);
+    rewind(fp);
+    if (size > 0) {
+        char *buf = malloc((size_t)size);
+        if (!buf) { fclose(fp); return 0; }
+        v->size = fread(buf, 1, (size_t)size, fp);
+        v->data = buf;
+    }
+    fclose(fp);
+    return 1;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return 0; }
+    if (st.st_size > 0) {
+        void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) { close(fd); return 0; }
+#ifdef MADV_SEQUENTIAL
+        madvise(m, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+        v->data = m;
+        v->size = (size_t)st.st_size;
+        v->mapped = 1;
+    }
+    close(fd);
+    return 1;
+#endif
+}
+
+void file_view_close(FileView *v) {
+#if !OS_WINDOWS
+    if (v->mapped) munmap((void *)v->data, v->size);
+    else
+#endif
+    free((void *)v->data);
+    v->data = NULL; v->size = 0; v->mapped = 0;
+}
+
+/* Flush stdio and force the data to stable storage. */
+int file_sync(FILE *fp) {
+    if (fflush(fp) != 0) return 0;
+#if OS_WINDOWS
+    return _commit(_fileno(fp)) == 0;
+#else
+    return fsync(fileno(fp)) == 0;
+#endif
+}
+
+/* Crash-safe rewrite: write to "<path>.tmp" from open_replacement(), then
+   commit_replacement() syncs it and renames it over path, so readers see either
+   the old file or the complete new one. */
+FILE *open_replacement(const char *path, char *tmpPath, size_t tmpLen, const char *mode) {
+    snprintf(tmpPath, tmpLen, "%s.tmp", path);
+    return fopen(tmpPath, mode);
+}
+
+int commit_replacement(FILE *fp, const char *tmpPath, const char *path) {
+    int ok = !ferror(fp) && file_sync(fp);
+    if (fclose(fp) != 0) ok = 0;
+#if OS_WINDOWS
+    if (ok) ok = MoveFileExA(tmpPath, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (ok) ok = rename(tmpPath, path) == 0;
+    if (ok) {
+        /* make the rename itself durable; the stores live in the working directory */
+        int dfd = open(".", O_RDONLY);
+        if (dfd >= 0) { fsync(dfd); close(dfd); }
+    }
+#endif
+    if (!ok) remove(tmpPath);
+    return ok;
+}
+
+int truncate_file(const char *path, long length) {
+#if OS_WINDOWS
+    int fd = _open(path, _O_RDWR | _O_BINARY);
+    if (fd < 0) return 0;
+    int ok = _chsize(fd, length) == 0;
+    _close(fd);
+    return ok;
+#else
+    return truncate(path, (off_t)length) == 0;
+#endif
+}
+
+/* Monotonic wall clock in seconds, for throughput reports. */
+double now_seconds(void) {
+#if OS_WINDOWS
+    LARGE_INTEGER freq, t;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (double)t.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+/* Copy a whole file over dstPath through open_replacement(), so dstPath is
+   either the old file or the complete copy. On Linux the bytes stay in the
+   kernel: copy_file_range() (which can share extents on filesystems that
+   support it), then sendfile() if that is unavailable or fails part way.
+   Whatever is left, or everything elsewhere, goes through a 1 MB read/write
+   loop that continues from the same offset. Returns the bytes copied, or -1. */
+#define COPY_BUF_SIZE (1 << 20)
+
+long long copy_file_atomic(const char *srcPath, const char *dstPath) {
+    FILE *src = fopen(srcPath, "rb");
+    if (!src) return -1;
+    char tmpPath[260];
+    FILE *dst = open_replacement(dstPath, tmpPath, sizeof(tmpPath), "wb");
+    if (!dst) { fclose(src); return -1; }
+    long long copied = 0;
+#if defined(__linux__)
+    int in = fileno(src), out = fileno(dst);
+    struct stat st;
+    long long left = fstat(in, &st) == 0 ? (long long)st.st_size : 0;
+    ssize_t got;
+    /* syscall() is declared under _DEFAULT_SOURCE; the copy_file_range()
+       wrapper would need _GNU_SOURCE */
+#ifdef SYS_copy_file_range
+    while (left > 0 && (got = syscall(SYS_copy_file_range, in, NULL, out, NULL, (size_t)left, 0u)) > 0) {
+        copied += got;
+        left -= got;
+    }
+#endif
+    while (left > 0 && (got = sendfile(out, in, NULL, (size_t)left)) > 0) {
+        copied += got;
+        left -= got;
+    }
+#endif
+    /* neither stdio stream has buffered anything yet, so they pick up at the
+       descriptors' offsets */
+    char small[4096];
+    char *buf = malloc(COPY_BUF_SIZE);
+    size_t cap = buf ? COPY_BUF_SIZE : sizeof(small);
+    if (!buf) buf = small;
+    int ok = 1;
+    size_t n;
+    while ((n = fread(buf, 1, cap, src)) > 0) {
+        if (fwrite(buf, 1, n, dst) != n) { ok = 0; break; }
+        copied += (long long)n;
+    }
+    if (ferror(src)) ok = 0;
+    if (buf != small) free(buf);
+    fclose(src);
+    if (!ok) { fclose(dst); remove(tmpPath); return -1; }
+    return commit_replacement(dst, tmpPath, dstPath) ? copied : -1;
+}
+
+/* "1.5 MB in 0.012 s (125.0 MB/s)"; small copies are shown in KB */
+void print_copy_rate(long long bytes, double seconds) {
+    if (bytes < 1048576) printf("%.1f KB in %.3f s", bytes / 1024.0, seconds);
+    else printf("%.1f MB in %.3f s", bytes / 1048576.0, seconds);
+    if (seconds > 0.0) printf(" (%.1f MB/s)", bytes / 1048576.0 / seconds);
+    printf("\n");
+}
+
+/* Line format: roll|name|m1|m2|m3\n */
+int write_student_to_file(FILE *fp, const Student *s) {
+    if (!fp || !s) return 0;
+    fprintf(fp, "%d|%s", s->roll, s->name);
+    for (int i = 0; i < SUBJECTS; ++i) fprintf(fp, "|%.2f", s->marks[i]);
+    fprintf(fp, "\n");
+    return 1;
+}
+
+/* Same line with marks to 9 significant digits, which reads back as the
+   identical float; for the journal of the lossless stores. */
+int write_student_exact(FILE *fp, const Student *s) {
+    if (!fp || !s) return 0;
+    fprintf(fp, "%d|%s", s->roll, s->name);
+    for (int i = 0; i < SUBJECTS; ++i) fprintf(fp, "|%.9g", s->marks[i]);
+    fprintf(fp, "\n");
+    return 1;
+}
+
+/* Field tokenizer with strtok("|") semantics over [p, end): empty fields are
+   skipped. Returns the token start and sets *tokEnd, or NULL when exhausted. */
+static const char *next_field(const char **p, const char *end, const char **tokEnd) {
+    const char *q = *p;
+    while (q < end && *q == '|') ++q;
+    if (q >= end) { *p = q; return NULL; }
+    const char *t = q;
+    while (q < end && *q != '|') ++q;
+    *tokEnd = q;
+    *p = q;
+    return t;
+}
+
+/* atoi() over a non-terminated field */
+static int decode_int(const char *p, const char *end) {
+    while (p < end && isspace((unsigned char)*p)) ++p;
+    int neg = 0;
+    if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+    unsigned v = 0;
+    while (p < end && *p >= '0' && *p <= '9') v = v * 10u + (unsigned)(*p++ - '0');
+    return neg ? (int)(0u - v) : (int)v;
+}
+
+/* atof() over a non-terminated field, without the locale or a heap copy.
+   Plain decimals (what write_student_to_file emits) are decoded as an exact
+   integer mantissa divided by an exact power of ten, which rounds the same way
+   strtod does; anything fancier (exponents, inf/nan, huge mantissas) falls back
+   to strtod on a small stack copy. */
+static float decode_float(const char *p, const char *end) {
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+    const char *start = p;
+    while (p < end && isspace((unsigned char)*p)) ++p;
+    int neg = 0;
+    if (p < end && (*p == '-' || *p == '+')) neg = (*p++ == '-');
+    unsigned long long mant = 0;
+    int digits = 0, scale = 0;
+    while (p < end && *p >= '0' && *p <= '9') { mant = mant * 10 + (unsigned)(*p++ - '0'); digits++; }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') { mant = mant * 10 + (unsigned)(*p++ - '0'); digits++; scale++; }
+    }
+    int fancy = p < end && strchr("eEiInNxX", *p) != NULL;
+    if (!fancy && digits <= 15 && scale <= 18) {
+        double v = (double)mant / pow10[scale];
+        return (float)(neg ? -v : v);
+    }
+    char buf[64];
+    size_t n = (size_t)(end - start);
+    if (n >= sizeof(buf)) n = sizeof(buf) - 1;
+    memcpy(buf, start, n);
+    buf[n] = '\0';
+    return (float)strtod(buf, NULL);
+}
+
+/* Parse one roll|name|m1|m2|m3 record held in [p, end) (no trailing newline).
+   Works in place: no allocation and no writes to the source bytes. */
+int parse_student_record(const char *p, const char *end, Student *s) {
+    if (!p || !s) return 0;
+    const char *te;
+    const char *tok = next_field(&p, end, &te);
+    if (!tok) return 0;
+    s->roll = decode_int(tok, te);
+    tok = next_field(&p, end, &te);
+    if (!tok) return 0;
+    size_t len = (size_t)(te - tok);
+    if (len > MAX_NAME - 1) len = MAX_NAME - 1;
+    memcpy(s->name, tok, len);
+    s->name[len] = '\0';
+    for (int i = 0; i < SUBJECTS; ++i) {
+        tok = next_field(&p, end, &te);
+        s->marks[i] = tok ? decode_float(tok, te) : 0.0f;
+    }
+    calculate_student(s);
+    return 1;
+}
+
+int parse_line_to_student(const char *line, Student *s) {
+    if (!line || !s) return 0;
+    size_t len = strlen(line);
+    if (len && line[len - 1] == '\n') len--;
+    return parse_student_record(line, line + len, s);
+}
+
+/* One newline-aligned slice of the mapped file, parsed into its own buffer. */
+typedef struct {
+    const char *begin, *end;
+    Student *recs;
+    int count;
+    int failed;
+} LoadChunk;
+
+static void *parse_chunk(void *arg) {
+    LoadChunk *c = arg;
+    int lines = 0;
+    for (const char *q = c->begin; q < c->end; ++lines) {
+        const char *nl = memchr(q, '\n', (size_t)(c->end - q));
+        q = nl ? nl + 1 : c->end;
+    }
+    c->count = 0;
+    c->recs = malloc((size_t)(lines ? lines : 1) * sizeof(Student));
+    if (!c->recs) { c->failed = 1; return NULL; }
+    for (const char *p = c->begin; p < c->end;) {
+        const char *nl = memchr(p, '\n', (size_t)(c->end - p));
+        const char *le = nl ? nl : c->end;
+        if (parse_student_record(p, le, &c->recs[c->count])) c->count++;
+        p = nl ? nl + 1 : c->end;
+    }
+    return NULL;
+}
+
+/* The file is mapped and parsed in place, so lines of any length are handled
+   and nothing is copied except the final Student fields. Large files are cut
+   at newline boundaries into one chunk per worker thread (see worker_threads);
+   chunks are parsed in parallel and concatenated in file order into a single
+   block, which is released with one free(). */
+Student *load_students(int *outCount, int *outCap) {
+    *outCount = 0;
+    if (outCap) *outCap = 0;
+    if (storageFormat == STORE_BINARY) return load_binary_students(STUDENT_BIN_FILE, outCount, outCap);
+    if (storageFormat == STORE_BTREE) return load_btree_students(outCount, outCap);
+    FileView v;
+    if (!file_view_open(STUDENT_FILE, &v)) return NULL;
+    const char *end = v.data + v.size;
+    int nthreads = v.size >= PARALLEL_LOAD_MIN_BYTES ? worker_threads() : 1;
+    LoadChunk chunks[MAX_WORKERS];
+    const char *p = v.data;
+    int nchunks = 0;
+    for (int i = 0; i < nthreads && p < end; ++i) {
+        const char *cut = i == nthreads - 1 ? end : v.data + v.size / (size_t)nthreads * (size_t)(i + 1);
+        if (cut < p) cut = p;
+        const char *nl = cut < end ? memchr(cut, '\n', (size_t)(end - cut)) : NULL;
+        cut = nl ? nl + 1 : end;
+        chunks[nchunks].begin = p;
+        chunks[nchunks].end = cut;
+        chunks[nchunks].recs = NULL;
+        chunks[nchunks].failed = 0;
+        nchunks++;
+        p = cut;
+    }
+    run_workers(parse_chunk, chunks, sizeof(LoadChunk), nchunks);
+    file_view_close(&v);
+
+    int total = 0, failed = 0;
+    for (int i = 0; i < nchunks; ++i) { total += chunks[i].count; failed |= chunks[i].failed; }
+    int cap = total + 16;
+    size_t peak = (size_t)cap * sizeof(Student);
+    int count = 0;
+    Student *arr = NULL;
+    if (nchunks == 1 && !failed) {
+        /* single chunk: adopt its buffer rather than copying it */
+        arr = realloc(chunks[0].recs, (size_t)cap * sizeof(Student));
+        if (!arr) free(chunks[0].recs);
+        count = chunks[0].count;
+        nchunks = 0;
+    } else if (!failed) arr = malloc((size_t)cap * sizeof(Student));
+    for (int i = 0; i < nchunks; ++i) {
+        if (arr && chunks[i].count) {
+            memcpy(&arr[count], chunks[i].recs, (size_t)chunks[i].count * sizeof(Student));
+            count += chunks[i].count;
+        }
+        if (nchunks > 1) peak += (size_t)chunks[i].count * sizeof(Student);
+        free(chunks[i].recs);
+    }
+    if (!arr) return NULL;
+    if (peak > tablePeakBytes) tablePeakBytes = peak;
+    *outCount = count;
+    if (outCap) *outCap = cap;
+    return arr;
+}
+
+Student *read_all_students(int *outCount) {
+    return load_students(outCount, NULL);
+}
+
+int roll_exists(int roll) {
+    return table_find_roll(roll) >= 0;
+}
+
+/* Adds go through the journal so they share its group commit. */
+int append_student(const Student *s) {
+    if (!journal_append('A', s, 0)) return 0;
+    if (storageFormat == STORE_BTREE && !btree_insert(s)) btreeStale = 1;
+    return 1;
+}
+
+int overwrite_students(Student *arr, int count) {
+    if (storageFormat == STORE_BINARY) return write_binary_students(STUDENT_BIN_FILE, arr, count);
+    if (storageFormat == STORE_BTREE) {
+        btree_close(); /* the file is replaced; cached pages are stale */
+        return btree_build(BTREE_FILE, arr, count);
+    }
+    char tmpPath[260];
+    FILE *fp = open_replacement(STUDENT_FILE, tmpPath, sizeof(tmpPath), "w");
+    if (!fp) return 0;
+    for (int i = 0; i < count; ++i) write_student_to_file(fp, &arr[i]);
+    return commit_replacement(fp, tmpPath, STUDENT_FILE);
+}
+
+const char *student_store_path(void) {
+    if (storageFormat == STORE_BTREE) return BTREE_FILE;
+    return storageFormat == STORE_BINARY ? STUDENT_BIN_FILE : STUDENT_FILE;
+}
+
+const char *student_backup_path(void) {
+    if (storageFormat == STORE_BTREE) return BACKUP_BTREE_FILE;
+    return storageFormat == STORE_BINARY ? BACKUP_BIN_FILE : BACKUP_FILE;
+}
+
+/* ---- Binary store ---- */
+/* Validate the header of a mapped students.bin; returns the record array or NULL. */
+static const BinRecord *bin_records(const FileView *v, BinHeader *h) {
+    if (v->size < sizeof(BinHeader)) return NULL;
+    memcpy(h, v->data, sizeof(BinHeader));
+    if (memcmp(h->magic, BIN_MAGIC, 4) != 0 || h->version != BIN_VERSION) return NULL;
+    size_t need = sizeof(BinHeader) + (size_t)h->count * sizeof(BinRecord) + h->heapSize;
+    if (need > v->size) return NULL;
+    return (const BinRecord *)(v->data + sizeof(BinHeader));
+}
+
+/* No parsing: each fixed record is read straight out of the mapping and only
+   the derived fields are recomputed. */
+Student *load_binary_students(const char *path, int *outCount, int *outCap) {
+    *outCount = 0;
+    if (outCap) *outCap = 0;
+    FileView v;
+    if (!file_view_open(path, &v)) return NULL;
+    BinHeader h;
+    const BinRecord *recs = bin_records(&v, &h);
+    if (!recs) { file_view_close(&v); return NULL; }
+    const char *heap = (const char *)(recs + h.count);
+    int cap = (int)h.count + 16;
+    Student *arr = malloc((size_t)cap * sizeof(Student));
+    if (!arr) { file_view_close(&v); return NULL; }
+    int count = 0;
+    for (unsigned i = 0; i < h.count; ++i) {
+        Student *s = &arr[count];
+        if ((size_t)recs[i].nameOff + recs[i].nameLen > h.heapSize) continue;
+        size_t len = recs[i].nameLen < MAX_NAME - 1 ? recs[i].nameLen : MAX_NAME - 1;
+        s->roll = recs[i].roll;
+        memcpy(s->name, heap + recs[i].nameOff, len);
+        s->name[len] = '\0';
+        memcpy(s->marks, recs[i].marks, sizeof(s->marks));
+        calculate_student(s);
+        count++;
+    }
+    file_view_close(&v);
+    if ((size_t)cap * sizeof(Student) > tablePeakBytes) tablePeakBytes = (size_t)cap * sizeof(Student);
+    *outCount = count;
+    if (outCap) *outCap = cap;
+    return arr;
+}
+
+int write_binary_students(const char *path, const Student *arr, int count) {
+    char tmpPath[260];
+    FILE *fp = open_replacement(path, tmpPath, sizeof(tmpPath), "wb");
+    if (!fp) return 0;
+    BinHeader h;
+    memcpy(h.magic, BIN_MAGIC, 4);
+    h.version = BIN_VERSION;
+    h.count = (unsigned)count;
+    h.heapSize = 0;
+    for (int i = 0; i < count; ++i) h.heapSize += (unsigned)strlen(arr[i].name);
+    int ok = fwrite(&h, sizeof(h), 1, fp) == 1;
+    unsigned off = 0;
+    for (int i = 0; i < count && ok; ++i) {
+        BinRecord r;
+        r.roll = arr[i].roll;
+        memcpy(r.marks, arr[i].marks, sizeof(r.marks));
+        r.nameOff = off;
+        r.nameLen = (unsigned)strlen(arr[i].name);
+        off += r.nameLen;
+        ok = fwrite(&r, sizeof(r), 1, fp) == 1;
+    }
+    for (int i = 0; i < count && ok; ++i) {
+        size_t len = strlen(arr[i].name);
+        ok = fwrite(arr[i].name, 1, len, fp) == len;
+    }
+    if (!ok) { fclose(fp); remove(tmpPath); return 0; }
+    return commit_replacement(fp, tmpPath, path);
+}
+
+/* Format whose file is current, as recorded in STORE_FORMAT_FILE; -1 if none. */
+static int read_store_format(void) {
+    FILE *f = fopen(STORE_FORMAT_FILE, "r");
+    if (!f) return -1;
+    char buf[16];
+    int fmt = -1;
+    if (fscanf(f, "%15s", buf) == 1)
+        for (int i = STORE_TEXT; i <= STORE_BTREE; ++i)
+            if (strcmp(buf, storeFormatNames[i]) == 0) fmt = i;
+    fclose(f);
+    return fmt;
+}
+
+int write_store_format(int fmt) {
+    char tmpPath[260];
+    FILE *f = open_replacement(STORE_FORMAT_FILE, tmpPath, sizeof(tmpPath), "w");
+    if (!f) return 0;
+    fprintf(f, "%s\n", storeFormatNames[fmt]);
+    return commit_replacement(f, tmpPath, STORE_FORMAT_FILE);
+}
+
+/* Pick the storage format from SRMS_FORMAT (default: the recorded one) and the
+   journal commit interval from SRMS_COMMIT_INTERVAL. Only the store named in
+   STORE_FORMAT_FILE is current; asking for another format converts it, with
+   its journal applied, so a file left over from an earlier switch is never
+   loaded. Trees from before the marker trust an existing file of the
+   requested format and otherwise convert students.txt. */
+void storage_init(void) {
+    const char *interval = getenv("SRMS_COMMIT_INTERVAL");
+    if (interval) commitInterval = atoi(interval);
+    int recorded = read_store_format();
+    int hadRecord = recorded >= 0;
+    const char *env = getenv("SRMS_FORMAT");
+    int target = hadRecord ? recorded : STORE_TEXT;
+    if (env) {
+        target = STORE_TEXT;
+        if (portable_strcasecmp(env, "binary") == 0) target = STORE_BINARY;
+        else if (portable_strcasecmp(env, "btree") == 0) target = STORE_BTREE;
+    }
+    if (!hadRecord) {
+        storageFormat = target;
+        FILE *f = fopen(student_store_path(), "rb");
+        recorded = f ? target : STORE_TEXT;
+        if (f) fclose(f);
+    }
+    storageFormat = recorded;
+    if (target == recorded) {
+        if (!hadRecord) write_store_format(recorded);
+        return;
+    }
+    table_load();
+    if (store_flush()) {
+        storageFormat = target;
+        table_compact();
+        if (!overwrite_students(studentTable, studentCount) || !write_store_format(target))
+            storageFormat = recorded;
+    }
+    if (storageFormat != target)
+        printf("Could not convert %s storage to %s; staying on %s.\n",
+               storeFormatNames[recorded], storeFormatNames[target], student_store_path());
+    btree_close();
+    table_unload();
+}
+
+/* ---- B+tree store ---- */
+/* students.db is a paged B+tree keyed on roll. Page 0 holds BtHeader; every
+   other page is a node that starts with BtNode. Leaves hold up to
+   BT_LEAF_CAP BtRecords sorted by roll and are chained left to right for
+   range scans; inner nodes hold BT_INNER_CAP separator keys where key[i] is
+   the smallest roll under child[i + 1]. Deletes just remove the record from
+   its leaf (no rebalancing); a checkpoint rebuild repacks the tree.
+
+   Pages are read through a small LRU cache. Modified pages stay pinned in the
+   cache until btree_flush() (no-steal), and the journal covers them until
+   then. A flush first writes every dirty page to BTREE_DW_FILE and syncs it,
+   then writes the pages in place, so a crash mid-flush is repaired by
+   replaying the double-write file on the next open. */
+static unsigned char *bt_page(unsigned pgno);
+
+static BtNode *bt_node(unsigned char *p) { return (BtNode *)p; }
+static BtRecord *bt_recs(unsigned char *p) { return (BtRecord *)(p + sizeof(BtNode)); }
+static unsigned *bt_children(unsigned char *p) { return (unsigned *)(p + sizeof(BtNode)); }
+static int *bt_keys(unsigned char *p) { return (int *)(p + sizeof(BtNode) + (BT_INNER_CAP + 1) * sizeof(unsigned)); }
+
+static void bt_to_student(const BtRecord *r, Student *s) {
+    s->roll = r->roll;
+    memcpy(s->name, r->name, MAX_NAME);
+    s->name[MAX_NAME - 1] = '\0';
+    memcpy(s->marks, r->marks, sizeof(s->marks));
+    calculate_student(s);
+}
+
+static void bt_from_student(const Student *s, BtRecord *r) {
+    memset(r, 0, sizeof(*r));
+    r->roll = s->roll;
+    memcpy(r->name, s->name, strnlen(s->name, MAX_NAME - 1));
+    memcpy(r->marks, s->marks, sizeof(r->marks));
+}
+
+/* Redo an interrupted flush from the double-write file, if one is complete. */
+static void bt_recover(void) {
+    FileView v;
+    if (!file_view_open(BTREE_DW_FILE, &v)) return;
+    size_t entry = sizeof(unsigned) + BTREE_PAGE;
+    unsigned count = 0;
+    if (v.size >= 8 && memcmp(v.data + v.size - 8, "SRDW", 4) == 0) memcpy(&count, v.data + v.size - 4, 4);
+    if (count > 0 && v.size == (size_t)count * entry + 8) {
+        FILE *fp = fopen(BTREE_FILE, "r+b");
+        if (fp) {
+            for (unsigned i = 0; i < count; ++i) {
+                unsigned pgno;
+                memcpy(&pgno, v.data + i * entry, sizeof(pgno));
+                fseek(fp, (long)pgno * BTREE_PAGE, SEEK_SET);
+                fwrite(v.data + i * entry + sizeof(unsigned), 1, BTREE_PAGE, fp);
+            }
+            file_sync(fp);
+            fclose(fp);
+        }
+    }
+    file_view_close(&v);
+    remove(BTREE_DW_FILE); /* an incomplete one never touched the tree */
+}
+
+static int bt_open(void) {
+    if (btree.fp) return 1;
+    bt_recover();
+    FILE *f = fopen(BTREE_FILE, "rb");
+    if (f) fclose(f);
+    else if (!btree_build(BTREE_FILE, NULL, 0)) return 0;
+    btree.fp = fopen(BTREE_FILE, "r+b");
+    if (!btree.fp) return 0;
+    unsigned char page[BTREE_PAGE];
+    if (fread(page, 1, BTREE_PAGE, btree.fp) != BTREE_PAGE) { btree_close(); return 0; }
+    memcpy(&btree.h, page, sizeof(BtHeader));
+    if (memcmp(btree.h.magic, BT_MAGIC, 4) != 0 || btree.h.version != BT_VERSION || btree.h.pageSize != BTREE_PAGE) {
+        btree_close();
+        return 0;
+    }
+    return 1;
+}
+
+/* Drop the cache without writing anything; unflushed pages are still in the journal. */
+void btree_close(void) {
+    for (int i = 0; i < btree.frameCount; ++i) free(btree.frames[i].data);
+    free(btree.frames);
+    free(btree.pageFrame);
+    if (btree.fp) fclose(btree.fp);
+    memset(&btree, 0, sizeof(btree));
+}
+
+static int bt_frame_slot(unsigned pgno) {
+    if (pgno >= btree.pageFrameCap) {
+        unsigned cap = btree.pageFrameCap ? btree.pageFrameCap : 256;
+        while (cap <= pgno) cap *= 2;
+        int *tmp = realloc(btree.pageFrame, cap * sizeof(int));
+        if (!tmp) return -2;
+        memset(tmp + btree.pageFrameCap, 0xff, (cap - btree.pageFrameCap) * sizeof(int));
+        btree.pageFrame = tmp;
+        btree.pageFrameCap = cap;
+    }
+    return btree.pageFrame[pgno];
+}
+
+/* Cached page for pgno; pointers stay valid until the next bt_trim(). */
+static unsigned char *bt_page(unsigned pgno) {
+    int slot = bt_frame_slot(pgno);
+    if (slot == -2) return NULL;
+    if (slot >= 0) {
+        btree.frames[slot].lastUse = ++btree.tick;
+        return btree.frames[slot].data;
+    }
+    if (btree.frameCount == btree.frameCap) {
+        int cap = btree.frameCap ? btree.frameCap * 2 : 64;
+        BtFrame *tmp = realloc(btree.frames, (size_t)cap * sizeof(BtFrame));
+        if (!tmp) return NULL;
+        btree.frames = tmp;
+        btree.frameCap = cap;
+    }
+    unsigned char *data = calloc(1, BTREE_PAGE);
+    if (!data) return NULL;
+    if (pgno < btree.h.pageCount && fseek(btree.fp, (long)pgno * BTREE_PAGE, SEEK_SET) == 0)
+        if (fread(data, 1, BTREE_PAGE, btree.fp) != BTREE_PAGE) memset(data, 0, BTREE_PAGE);
+    BtFrame *f = &btree.frames[btree.frameCount];
+    f->pgno = pgno;
+    f->dirty = 0;
+    f->lastUse = ++btree.tick;
+    f->data = data;
+    btree.pageFrame[pgno] = btree.frameCount++;
+    return data;
+}
+
+static void bt_dirty(unsigned pgno) {
+    int slot = bt_frame_slot(pgno);
+    if (slot >= 0) btree.frames[slot].dirty = 1;
+}
+
+static unsigned bt_alloc(int type) {
+    unsigned pgno = btree.h.pageCount++;
+    unsigned char *p = bt_page(pgno);
+    if (!p) return 0;
+    memset(p, 0, BTREE_PAGE);
+    bt_node(p)->type = (unsigned short)type;
+    bt_dirty(pgno);
+    return pgno;
+}
+
+/* Evict least recently used clean pages until the cache fits again. Only
+   called between operations, never while page pointers are held. */
+static void bt_trim(void) {
+    while (btree.frameCount > BTREE_CACHE_PAGES) {
+        int victim = -1;
+        for (int i = 0; i < btree.frameCount; ++i)
+            if (!btree.frames[i].dirty && (victim < 0 || btree.frames[i].lastUse < btree.frames[victim].lastUse)) victim = i;
+        if (victim < 0) return; /* everything is dirty: keep it until the flush */
+        btree.pageFrame[btree.frames[victim].pgno] = -1;
+        free(btree.frames[victim].data);
+        btree.frames[victim] = btree.frames[--btree.frameCount];
+        if (victim < btree.frameCount) btree.pageFrame[btree.frames[victim].pgno] = victim;
+    }
+}
+
+/* number of separator keys <= roll, i.e. which child to descend into */
+static int bt_child_slot(unsigned char *p, int roll) {
+    int lo = 0, hi = bt_node(p)->count;
+    const int *keys = bt_keys(p);
+    while (lo < hi) { int mid = (lo + hi) / 2; if (keys[mid] <= roll) lo = mid + 1; else hi = mid; }
+    return lo;
+}
+
+/* first record slot with roll >= the key */
+static int bt_leaf_slot(unsigned char *p, int roll) {
+    int lo = 0, hi = bt_node(p)->count;
+    const BtRecord *recs = bt_recs(p);
+    while (lo < hi) { int mid = (lo + hi) / 2; if (recs[mid].roll < roll) lo = mid + 1; else hi = mid; }
+    return lo;
+}
+
+static unsigned bt_find_leaf(int roll) {
+    unsigned pg = btree.h.root;
+    for (unsigned lvl = btree.h.height; lvl > 0; --lvl) {
+        unsigned char *p = bt_page(pg);
+        if (!p) return 0;
+        pg = bt_children(p)[bt_child_slot(p, roll)];
+    }
+    return pg;
+}
+
+/* Insert under pg. Returns -1 on duplicate/error, 0 when done, 1 when pg split
+   and (*sepKey, *newPg) must be added to the parent. */
+static int bt_insert_at(unsigned pg, unsigned lvl, const BtRecord *r, int *sepKey, unsigned *newPg) {
+    unsigned char *p = bt_page(pg);
+    if (!p) return -1;
+    if (lvl == 0) {
+        BtRecord *recs = bt_recs(p);
+        int n = bt_node(p)->count;
+        int i = bt_leaf_slot(p, r->roll);
+        if (i < n && recs[i].roll == r->roll) return -1;
+        if (n < (int)BT_LEAF_CAP) {
+            memmove(&recs[i + 1], &recs[i], (size_t)(n - i) * sizeof(BtRecord));
+            recs[i] = *r;
+            bt_node(p)->count++;
+            bt_dirty(pg);
+            return 0;
+        }
+        BtRecord all[BT_LEAF_CAP + 1];
+        memcpy(all, recs, (size_t)i * sizeof(BtRecord));
+        all[i] = *r;
+        memcpy(&all[i + 1], &recs[i], (size_t)(n - i) * sizeof(BtRecord));
+        unsigned np = bt_alloc(BT_LEAF);
+        unsigned char *q = np ? bt_page(np) : NULL;
+        if (!q) return -1;
+        int left = (n + 1) / 2;
+        memcpy(recs, all, (size_t)left * sizeof(BtRecord));
+        memcpy(bt_recs(q), &all[left], (size_t)(n + 1 - left) * sizeof(BtRecord));
+        bt_node(p)->count = (unsigned short)left;
+        bt_node(q)->count = (unsigned short)(n + 1 - left);
+        bt_node(q)->next = bt_node(p)->next;
+        bt_node(p)->next = np;
+        bt_dirty(pg);
+        *sepKey = bt_recs(q)[0].roll;
+        *newPg = np;
+        return 1;
+    }
+    int slot = bt_child_slot(p, r->roll);
+    int childKey;
+    unsigned childPg;
+    int res = bt_insert_at(bt_children(p)[slot], lvl - 1, r, &childKey, &childPg);
+    if (res != 1) return res;
+    p = bt_page(pg);
+    int n = bt_node(p)->count;
+    int *keys = bt_keys(p);
+    unsigned *kids = bt_children(p);
+    if (n < (int)BT_INNER_CAP) {
+        memmove(&keys[slot + 1], &keys[slot], (size_t)(n - slot) * sizeof(int));
+        memmove(&kids[slot + 2], &kids[slot + 1], (size_t)(n - slot) * sizeof(unsigned));
+        keys[slot] = childKey;
+        kids[slot + 1] = childPg;
+        bt_node(p)->count++;
+        bt_dirty(pg);
+        return 0;
+    }
+    int allKeys[BT_INNER_CAP + 1];
+    unsigned allKids[BT_INNER_CAP + 2];
+    memcpy(allKeys, keys, (size_t)slot * sizeof(int));
+    allKeys[slot] = childKey;
+    memcpy(&allKeys[slot + 1], &keys[slot], (size_t)(n - slot) * sizeof(int));
+    memcpy(allKids, kids, (size_t)(slot + 1) * sizeof(unsigned));
+    allKids[slot + 1] = childPg;
+    memcpy(&allKids[slot + 2], &kids[slot + 1], (size_t)(n - slot) * sizeof(unsigned));
+    unsigned np = bt_alloc(BT_INNER);
+    unsigned char *q = np ? bt_page(np) : NULL;
+    if (!q) return -1;
+    int mid = (n + 1) / 2; /* allKeys[mid] moves up */
+    memcpy(keys, allKeys, (size_t)mid * sizeof(int));
+    memcpy(kids, allKids, (size_t)(mid + 1) * sizeof(unsigned));
+    bt_node(p)->count = (unsigned short)mid;
+    memcpy(bt_keys(q), &allKeys[mid + 1], (size_t)(n - mid) * sizeof(int));
+    memcpy(bt_children(q), &allKids[mid + 1], (size_t)(n - mid + 1) * sizeof(unsigned));
+    bt_node(q)->count = (unsigned short)(n - mid);
+    bt_dirty(pg);
+    *sepKey = allKeys[mid];
+    *newPg = np;
+    return 1;
+}
+
+int btree_insert(const Student *s) {
+    if (!bt_open()) return 0;
+    bt_trim();
+    BtRecord r;
+    bt_from_student(s, &r);
+    int sep;
+    unsigned np;
+    int res = bt_insert_at(btree.h.root, btree.h.height, &r, &sep, &np);
+    if (res < 0) return 0;
+    if (res == 1) {
+        unsigned root = bt_alloc(BT_INNER);
+        unsigned char *p = root ? bt_page(root) : NULL;
+        if (!p) return 0;
+        bt_children(p)[0] = btree.h.root;
+        bt_children(p)[1] = np;
+        bt_keys(p)[0] = sep;
+        bt_node(p)->count = 1;
+        btree.h.root = root;
+        btree.h.height++;
+    }
+    btree.h.recordCount++;
+    return 1;
+}
+
+/* In-place update of an existing record; returns 0 if the roll is absent. */
+int btree_update(const Student *s) {
+    if (!bt_open()) return 0;
+    bt_trim();
+    unsigned pg = bt_find_leaf(s->roll);
+    unsigned char *p = pg ? bt_page(pg) : NULL;
+    if (!p) return 0;
+    int i = bt_leaf_slot(p, s->roll);
+    if (i >= bt_node(p)->count || bt_recs(p)[i].roll != s->roll) return 0;
+    bt_from_student(s, &bt_recs(p)[i]);
+    bt_dirty(pg);
+    return 1;
+}
+
+int btree_delete(int roll) {
+    if (!bt_open()) return 0;
+    bt_trim();
+    unsigned pg = bt_find_leaf(roll);
+    unsigned char *p = pg ? bt_page(pg) : NULL;
+    if (!p) return 0;
+    int n = bt_node(p)->count;
+    int i = bt_leaf_slot(p, roll);
+    if (i >= n || bt_recs(p)[i].roll != roll) return 0;
+    memmove(&bt_recs(p)[i], &bt_recs(p)[i + 1], (size_t)(n - i - 1) * sizeof(BtRecord));
+    bt_node(p)->count--;
+    bt_dirty(pg);
+    btree.h.recordCount--;
+    return 1;
+}
+
+int btree_lookup(int roll, Student *out) {
+    if (!bt_open()) return 0;
+    bt_trim();
+    unsigned pg = bt_find_leaf(roll);
+    unsigned char *p = pg ? bt_page(pg) : NULL;
+    if (!p) return 0;
+    int i = bt_leaf_slot(p, roll);
+    if (i >= bt_node(p)->count || bt_recs(p)[i].roll != roll) return 0;
+    bt_to_student(&bt_recs(p)[i], out);
+    return 1;
+}
+
+/* Call fn for every record with lo <= roll <= hi, in roll order. */
+int btree_scan(int lo, int hi, void (*fn)(const Student *, void *), void *ctx) {
+    if (!bt_open()) return -1;
+    bt_trim();
+    unsigned pg = bt_find_leaf(lo);
+    int count = 0;
+    while (pg) {
+        unsigned char *p = bt_page(pg);
+        if (!p) return -1;
+        const BtRecord *recs = bt_recs(p);
+        int n = bt_node(p)->count;
+        for (int i = bt_leaf_slot(p, lo); i < n; ++i) {
+            if (recs[i].roll > hi) return count;
+            Student s;
+            bt_to_student(&recs[i], &s);
+            fn(&s, ctx);
+            count++;
+        }
+        pg = bt_node(p)->next;
+        bt_trim();
+    }
+    return count;
+}
+
+/* Write every dirty page durably: double-write file first, then in place. */
+int btree_flush(void) {
+    if (!btree.fp) return 1;
+    unsigned char header[BTREE_PAGE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, &btree.h, sizeof(BtHeader));
+    FILE *dw = fopen(BTREE_DW_FILE, "wb");
+    if (!dw) return 0;
+    unsigned count = 0, zero = 0;
+    int ok = 1;
+    for (int i = 0; i < btree.frameCount && ok; ++i) {
+        if (!btree.frames[i].dirty) continue;
+        ok = fwrite(&btree.frames[i].pgno, sizeof(unsigned), 1, dw) == 1
+            && fwrite(btree.frames[i].data, 1, BTREE_PAGE, dw) == BTREE_PAGE;
+        count++;
+    }
+    if (ok) ok = fwrite(&zero, sizeof(unsigned), 1, dw) == 1 && fwrite(header, 1, BTREE_PAGE, dw) == BTREE_PAGE;
+    count++;
+    if (ok) ok = fwrite("SRDW", 1, 4, dw) == 4 && fwrite(&count, sizeof(count), 1, dw) == 1;
+    if (ok) ok = file_sync(dw);
+    if (fclose(dw) != 0) ok = 0;
+    if (!ok) { remove(BTREE_DW_FILE); return 0; }
+    for (int i = 0; i < btree.frameCount && ok; ++i) {
+        if (!btree.frames[i].dirty) continue;
+        ok = fseek(btree.fp, (long)btree.frames[i].pgno * BTREE_PAGE, SEEK_SET) == 0
+            && fwrite(btree.frames[i].data, 1, BTREE_PAGE, btree.fp) == BTREE_PAGE;
+    }
+    if (ok) ok = fseek(btree.fp, 0, SEEK_SET) == 0 && fwrite(header, 1, BTREE_PAGE, btree.fp) == BTREE_PAGE;
+    if (ok) ok = file_sync(btree.fp);
+    if (!ok) return 0; /* the double-write file repairs this on the next open */
+    remove(BTREE_DW_FILE);
+    for (int i = 0; i < btree.frameCount; ++i) btree.frames[i].dirty = 0;
+    return 1;
+}
+
+static void bt_collect(const Student *s, void *ctx) {
+    StudentBuf *buf = ctx;
+    if (buf->count < buf->cap) buf->rows[buf->count++] = *s;
+}
+
+Student *load_btree_students(int *outCount, int *outCap) {
+    *outCount = 0;
+    if (outCap) *outCap = 0;
+    if (!bt_open()) return NULL;
+    StudentBuf buf;
+    buf.cap = (int)btree.h.recordCount + 16;
+    buf.count = 0;
+    buf.rows = malloc((size_t)buf.cap * sizeof(Student));
+    if (!buf.rows) return NULL;
+    if (btree_scan(INT_MIN, INT_MAX, bt_collect, &buf) < 0) { free(buf.rows); return NULL; }
+    if ((size_t)buf.cap * sizeof(Student) > tablePeakBytes) tablePeakBytes = (size_t)buf.cap * sizeof(Student);
+    *outCount = buf.count;
+    if (outCap) *outCap = buf.cap;
+    return buf.rows;
+}
+
+typedef struct { int roll; int idx; } BtSortKey;
+
+static int cmp_bt_sort_key(const void *a, const void *b) {
+    const BtSortKey *x = a, *y = b;
+    if (x->roll != y->roll) return x->roll < y->roll ? -1 : 1;
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+/* Bulk-load a fresh tree from arr (any order; the first of duplicate rolls
+   wins): full leaves written left to right, then each inner level above
+   them. The file is replaced atomically. */
+int btree_build(const char *path, const Student *arr, int count) {
+    BtSortKey *order = malloc((size_t)(count ? count : 1) * sizeof(BtSortKey));
+    unsigned *levelPg = malloc(((size_t)count / BT_LEAF_CAP + 2) * sizeof(unsigned));
+    int *levelKey = malloc(((size_t)count / BT_LEAF_CAP + 2) * sizeof(int));
+    unsigned char *page = malloc(BTREE_PAGE);
+    char tmpPath[260];
+    FILE *fp = (order && levelPg && levelKey && page) ? open_replacement(path, tmpPath, sizeof(tmpPath), "wb") : NULL;
+    if (!fp) { free(order); free(levelPg); free(levelKey); free(page); return 0; }
+    for (int i = 0; i < count; ++i) { order[i].roll = arr[i].roll; order[i].idx = i; }
+    qsort(order, (size_t)count, sizeof(BtSortKey), cmp_bt_sort_key);
+    int unique = 0;
+    for (int i = 0; i < count; ++i)
+        if (unique == 0 || order[i].roll != order[unique - 1].roll) order[unique++] = order[i];
+
+    BtHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BT_MAGIC, 4);
+    h.version = BT_VERSION;
+    h.pageSize = BTREE_PAGE;
+    h.recordCount = (unsigned)unique;
+    memset(page, 0, BTREE_PAGE);
+    int ok = fwrite(page, 1, BTREE_PAGE, fp) == BTREE_PAGE; /* header placeholder */
+    unsigned pgno = 1;
+    int nodes = 0;
+    for (int i = 0; ok && (i < unique || nodes == 0); i += BT_LEAF_CAP) {
+        int n = unique - i < (int)BT_LEAF_CAP ? unique - i : (int)BT_LEAF_CAP;
+        memset(page, 0, BTREE_PAGE);
+        bt_node(page)->type = BT_LEAF;
+        bt_node(page)->count = (unsigned short)n;
+        bt_node(page)->next = i + n < unique ? pgno + 1 : 0;
+        for (int j = 0; j < n; ++j) bt_from_student(&arr[order[i + j].idx], &bt_recs(page)[j]);
+        levelPg[nodes] = pgno;
+        levelKey[nodes++] = n ? bt_recs(page)[0].roll : 0;
+        ok = fwrite(page, 1, BTREE_PAGE, fp) == BTREE_PAGE;
+        pgno++;
+    }
+    while (ok && nodes > 1) {
+        int up = 0;
+        for (int i = 0; ok && i < nodes; i += BT_INNER_CAP + 1) {
+            int n = nodes - i < (int)BT_INNER_CAP + 1 ? nodes - i : (int)BT_INNER_CAP + 1;
+            memset(page, 0, BTREE_PAGE);
+            bt_node(page)->type = BT_INNER;
+            bt_node(page)->count = (unsigned short)(n - 1);
+            for (int j = 0; j < n; ++j) {
+                bt_children(page)[j] = levelPg[i + j];
+                if (j > 0) bt_keys(page)[j - 1] = levelKey[i + j];
+            }
+            levelKey[up] = levelKey[i];
+            levelPg[up++] = pgno;
+            ok = fwrite(page, 1, BTREE_PAGE, fp) == BTREE_PAGE;
+            pgno++;
+        }
+        nodes = up;
+        h.height++;
+    }
+    h.root = levelPg[0];
+    h.pageCount = pgno;
+    memset(page, 0, BTREE_PAGE);
+    memcpy(page, &h, sizeof(h));
+    if (ok) ok = fseek(fp, 0, SEEK_SET) == 0 && fwrite(page, 1, BTREE_PAGE, fp) == BTREE_PAGE;
+    free(order); free(levelPg); free(levelKey); free(page);
+    if (!ok) { fclose(fp); remove(tmpPath); return 0; }
+    return commit_replacement(fp, tmpPath, path);
+}
+
+
+/* ---- Roll index ---- */
+static unsigned roll_hash(int roll, int cap) {
+    unsigned h = (unsigned)roll * 2654435761u;
+    h ^= h >> 16;
+    return h & (unsigned)(cap - 1);
+}
+
+static int roll_index_resize(int cap) {
+    int *fresh = malloc((size_t)cap * sizeof(int));
+    if (!fresh) return 0;
+    memset(fresh, 0xff, (size_t)cap * sizeof(int));
+    for (int i = 0; i < rollIndexCap; ++i) {
+        if (rollIndex[i] == -1) continue;
+        unsigned h = roll_hash(studentTable[rollIndex[i]].roll, cap);
+        while (fresh[h] != -1) h = (h + 1) & (unsigned)(cap - 1);
+        fresh[h] = rollIndex[i];
+    }
+    free(rollIndex);
+    rollIndex = fresh;
+    rollIndexCap = cap;
+    return 1;
+}
+
+/* Rebuild the index from the table, sized so it stays at most half full. */
+int roll_index_rebuild(void) {
+    int cap = 16;
+    while (cap < studentCount * 2 + 2) cap *= 2;
+    free(rollIndex);
+    rollIndex = NULL;
+    rollIndexCap = rollIndexUsed = 0;
+    if (!roll_index_resize(cap)) return 0;
+    for (int i = 0; i < studentCount; ++i)
+        if (!studentDead[i] && !roll_index_put(studentTable[i].roll, i)) return 0;
+    return 1;
+}
+
+/* Insert roll -> idx. The first occurrence of a duplicated roll wins, like the old scan. */
+int roll_index_put(int roll, int idx) {
+    if ((rollIndexUsed + 1) * 2 > rollIndexCap && !roll_index_resize(rollIndexCap ? rollIndexCap * 2 : 16)) return 0;
+    unsigned h = roll_hash(roll, rollIndexCap);
+    while (rollIndex[h] != -1) {
+        if (studentTable[rollIndex[h]].roll == roll) return 1;
+        h = (h + 1) & (unsigned)(rollIndexCap - 1);
+    }
+    rollIndex[h] = idx;
+    rollIndexUsed++;
+    return 1;
+}
+
+/* Backward-shift deletion keeps every probe chain unbroken without tombstones. */
+void roll_index_remove(int roll) {
+    if (rollIndexCap == 0) return;
+    unsigned mask = (unsigned)(rollIndexCap - 1);
+    unsigned i = roll_hash(roll, rollIndexCap);
+    while (rollIndex[i] != -1 && studentTable[rollIndex[i]].roll != roll) i = (i + 1) & mask;
+    if (rollIndex[i] == -1) return;
+    for (unsigned j = (i + 1) & mask; rollIndex[j] != -1; j = (j + 1) & mask) {
+        unsigned home = roll_hash(studentTable[rollIndex[j]].roll, rollIndexCap);
+        /* move j back into the hole unless its home lies cyclically in (i, j] */
+        int stays = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) { rollIndex[i] = rollIndex[j]; i = j; }
+    }
+    rollIndex[i] = -1;
+    rollIndexUsed--;
+}
+
+int roll_index_get(int roll) {
+    if (rollIndexCap == 0) return -1;
+    unsigned h = roll_hash(roll, rollIndexCap);
+    while (rollIndex[h] != -1) {
+        if (studentTable[rollIndex[h]].roll == roll) return rollIndex[h];
+        h = (h + 1) & (unsigned)(rollIndexCap - 1);
+    }
+    return -1;
+}
+
+/* ---- Column store ---- */
+/* The live rows again, one array per hot field, so passes over marks or
+   percentages read 4 bytes per student instead of a whole Student. Columns
+   are dense: a delete moves the last row into the hole, and slot[] maps each
+   position back to its table slot (colPos[] is the reverse). Names live in
+   an append-only heap; a rename or delete leaves its old bytes behind until
+   the heap is rewritten by the next rebuild. After a failed allocation the
+   columns are marked invalid and rebuilt by the next cols_ready(). */
+static int cols_grow(void **p, size_t elem, int cap) {
+    void *grown = realloc(*p, (size_t)cap * elem);
+    if (!grown) return 0;
+    *p = grown;
+    return 1;
+}
+
+static int cols_reserve(int need) {
+    if (need > cols.cap) {
+        int cap = cols.cap ? cols.cap : 64;
+        while (cap < need) cap *= 2;
+        if (!cols_grow((void **)&cols.slot, sizeof(int), cap) ||
+            !cols_grow((void **)&cols.roll, sizeof(int), cap) ||
+            !cols_grow((void **)&cols.total, sizeof(float), cap) ||
+            !cols_grow((void **)&cols.pct, sizeof(float), cap) ||
+            !cols_grow((void **)&cols.grade, 1, cap) ||
+            !cols_grow((void **)&cols.nameOff, sizeof(unsigned), cap)) return 0;
+        for (int j = 0; j < SUBJECTS; ++j)
+            if (!cols_grow((void **)&cols.marks[j], sizeof(float), cap)) return 0;
+        cols.cap = cap;
+    }
+    if (studentCap > cols.posCap) {
+        if (!cols_grow((void **)&cols.colPos, sizeof(int), studentCap)) return 0;
+        cols.posCap = studentCap;
+    }
+    return 1;
+}
+
+/* Copy a name into the heap; returns its offset or UINT_MAX. */
+static unsigned cols_put_name(const char *name) {
+    size_t len = strlen(name) + 1;
+    if (cols.heapSize + len > cols.heapCap) {
+        size_t cap = cols.heapCap ? cols.heapCap : 4096;
+        while (cap < cols.heapSize + len) cap *= 2;
+        char *grown = realloc(cols.heap, cap);
+        if (!grown) return UINT_MAX;
+        cols.heap = grown;
+        cols.heapCap = cap;
+    }
+    memcpy(cols.heap + cols.heapSize, name, len);
+    unsigned off = (unsigned)cols.heapSize;
+    cols.heapSize += len;
+    return off;
+}
+
+/* Write table slot idx into column position pos. */
+static int cols_store(int pos, int idx) {
+    const Student *s = &studentTable[idx];
+    unsigned off = cols_put_name(s->name);
+    if (off == UINT_MAX) return 0;
+    cols.slot[pos] = idx;
+    cols.roll[pos] = s->roll;
+    for (int j = 0; j < SUBJECTS; ++j) cols.marks[j][pos] = s->marks[j];
+    cols.total[pos] = s->total;
+    cols.pct[pos] = s->percentage;
+    cols.grade[pos] = s->grade;
+    cols.nameOff[pos] = off;
+    cols.colPos[idx] = pos;
+    return 1;
+}
+
+void cols_free(void) {
+    free(cols.slot);
+    free(cols.roll);
+    for (int j = 0; j < SUBJECTS; ++j) free(cols.marks[j]);
+    free(cols.total);
+    free(cols.pct);
+    free(cols.grade);
+    free(cols.nameOff);
+    free(cols.colPos);
+    free(cols.heap);
+    memset(&cols, 0, sizeof(cols));
+}
+
+int cols_rebuild(void) {
+    cols.valid = 0;
+    cols.count = 0;
+    cols.heapSize = cols.heapGarbage = 0;
+    if (!cols_reserve(table_live_count())) { cols_free(); return 0; }
+    for (int i = 0; i < studentCount; ++i) {
+        if (studentDead[i]) continue;
+        if (!cols_store(cols.count, i)) { cols_free(); return 0; }
+        cols.count++;
+    }
+    cols.valid = 1;
+    return 1;
+}
+
+int cols_ready(void) {
+    return cols.valid || cols_rebuild();
+}
+
+void cols_append(int idx) {
+    if (!cols.valid) return;
+    if (!cols_reserve(cols.count + 1) || !cols_store(cols.count, idx)) { cols.valid = 0; return; }
+    cols.count++;
+}
+
+/* Refresh the columns of a row edited in place. */
+void cols_update(int idx) {
+    if (!cols.valid) return;
+    int pos = cols.colPos[idx];
+    cols.heapGarbage += strlen(cols.heap + cols.nameOff[pos]) + 1;
+    if (!cols_store(pos, idx)) cols.valid = 0;
+    else if (cols.heapGarbage > cols.heapSize / 2) cols_rebuild();
+}
+
+void cols_remove(int idx) {
+    if (!cols.valid) return;
+    int pos = cols.colPos[idx], last = cols.count - 1;
+    cols.heapGarbage += strlen(cols.heap + cols.nameOff[pos]) + 1;
+    if (pos != last) {
+        cols.slot[pos] = cols.slot[last];
+        cols.roll[pos] = cols.roll[last];
+        for (int j = 0; j < SUBJECTS; ++j) cols.marks[j][pos] = cols.marks[j][last];
+        cols.total[pos] = cols.total[last];
+        cols.pct[pos] = cols.pct[last];
+        cols.grade[pos] = cols.grade[last];
+        cols.nameOff[pos] = cols.nameOff[last];
+        cols.colPos[cols.slot[pos]] = pos;
+    }
+    cols.count--;
+}
+
+const char *col_name(int pos) {
+    return cols.heap + cols.nameOff[pos];
+}
+
+size_t cols_bytes(void) {
+    size_t perRow = 2 * sizeof(int) + (SUBJECTS + 2) * sizeof(float) + 1 + sizeof(unsigned);
+    return (size_t)cols.cap * perRow + (size_t)cols.posCap * sizeof(int) + cols.heapCap;
+}
+
+/* ---- Class statistics ---- */
+/* One pass over the percentage and marks columns yields the class summary:
+   percentage sum/min/max/pass count and per-subject sum, sum of squares,
+   min and max. Sums are kept in doubles. The SSE2 and AVX2 kernels do 4 or
+   8 rows per step without branches. The pass keeps only the min and max
+   values; the students holding them are found afterwards with a compare
+   scan, ties going to the earliest table slot. Large tables are split
+   across worker threads and the partial results merged. */
+/* Square root by Newton's method from above, so the build needs no libm; it
+   stops once the estimate stops falling. */
+static double stats_sqrt(double v) {
+    if (!(v > 0.0)) return 0.0;
+    double r = v > 1.0 ? v : 1.0;
+    for (;;) {
+        double next = 0.5 * (r + v / r);
+        if (next >= r) return r;
+        r = next;
+    }
+}
+
+static void stats_init(ClassStats *st) {
+    memset(st, 0, sizeof(*st));
+    st->pctMin = 101.0f;
+    st->pctMax = -1.0f;
+    for (int j = 0; j < SUBJECTS; ++j) { st->min[j] = 101.0f; st->max[j] = -1.0f; }
+}
+
+static void stats_merge(ClassStats *dst, const ClassStats *src) {
+    dst->count += src->count;
+    dst->pctSum += src->pctSum;
+    dst->pass += src->pass;
+    if (src->pctMin < dst->pctMin) dst->pctMin = src->pctMin;
+    if (src->pctMax > dst->pctMax) dst->pctMax = src->pctMax;
+    for (int j = 0; j < SUBJECTS; ++j) {
+        dst->sum[j] += src->sum[j];
+        dst->sumSq[j] += src->sumSq[j];
+        if (src->min[j] < dst->min[j]) dst->min[j] = src->min[j];
+        if (src->max[j] > dst->max[j]) dst->max[j] = src->max[j];
+    }
+}
+
+static void stats_scalar(int lo, int hi, ClassStats *st) {
+    stats_init(st);
+    for (int k = lo; k < hi; ++k) {
+        float v = cols.pct[k];
+        st->pctSum += v;
+        if (v < st->pctMin) st->pctMin = v;
+        if (v > st->pctMax) st->pctMax = v;
+        st->pass += v >= 50.0f;
+        for (int j = 0; j < SUBJECTS; ++j) {
+            double m = cols.marks[j][k];
+            st->sum[j] += m;
+            st->sumSq[j] += m * m;
+            if (cols.marks[j][k] < st->min[j]) st->min[j] = cols.marks[j][k];
+            if (cols.marks[j][k] > st->max[j]) st->max[j] = cols.marks[j][k];
+        }
+    }
+    st->count = hi - lo;
+}
+
+#if SIMD_X86
+/* Fold the vector lanes (spilled to arrays) and the scalar tail into st. */
+static void stats_finish(ClassStats *st, int lanes, const float *pmin, const float *pmax, const double *psum,
+                         const int *pass, const float *mn, const float *mx, const double *s, const double *q,
+                         int done, int hi) {
+    stats_scalar(done, hi, st);
+    for (int l = 0; l < lanes; ++l) {
+        if (pmin[l] < st->pctMin) st->pctMin = pmin[l];
+        if (pmax[l] > st->pctMax) st->pctMax = pmax[l];
+        st->pass += pass[l];
+        for (int j = 0; j < SUBJECTS; ++j) {
+            if (mn[j * lanes + l] < st->min[j]) st->min[j] = mn[j * lanes + l];
+            if (mx[j * lanes + l] > st->max[j]) st->max[j] = mx[j * lanes + l];
+        }
+    }
+    for (int l = 0; l < lanes / 2; ++l) {
+        st->pctSum += psum[l];
+        for (int j = 0; j < SUBJECTS; ++j) {
+            st->sum[j] += s[j * (lanes / 2) + l];
+            st->sumSq[j] += q[j * (lanes / 2) + l];
+        }
+    }
+}
+
+static void stats_sse2(int lo, int hi, ClassStats *st) {
+    __m128 pmin = _mm_set1_ps(101.0f), pmax = _mm_set1_ps(-1.0f), half = _mm_set1_ps(50.0f);
+    __m128d psum = _mm_setzero_pd();
+    __m128i pass = _mm_setzero_si128();
+    __m128 mn[SUBJECTS], mx[SUBJECTS];
+    __m128d s[SUBJECTS], q[SUBJECTS];
+    for (int j = 0; j < SUBJECTS; ++j) { mn[j] = pmin; mx[j] = pmax; s[j] = q[j] = psum; }
+    int k = lo;
+    for (; k + 4 <= hi; k += 4) {
+        __m128 v = _mm_loadu_ps(cols.pct + k);
+        pmin = _mm_min_ps(pmin, v);
+        pmax = _mm_max_ps(pmax, v);
+        psum = _mm_add_pd(psum, _mm_add_pd(_mm_cvtps_pd(v), _mm_cvtps_pd(_mm_movehl_ps(v, v))));
+        pass = _mm_sub_epi32(pass, _mm_castps_si128(_mm_cmpge_ps(v, half)));
+        for (int j = 0; j < SUBJECTS; ++j) {
+            __m128 m = _mm_loadu_ps(cols.marks[j] + k);
+            __m128d a = _mm_cvtps_pd(m), b = _mm_cvtps_pd(_mm_movehl_ps(m, m));
+            mn[j] = _mm_min_ps(mn[j], m);
+            mx[j] = _mm_max_ps(mx[j], m);
+            s[j] = _mm_add_pd(s[j], _mm_add_pd(a, b));
+            q[j] = _mm_add_pd(q[j], _mm_add_pd(_mm_mul_pd(a, a), _mm_mul_pd(b, b)));
+        }
+    }
+    float fmin[4], fmax[4], smn[SUBJECTS * 4], smx[SUBJECTS * 4];
+    double dsum[2], ds[SUBJECTS * 2], dq[SUBJECTS * 2];
+    int ipass[4];
+    _mm_storeu_ps(fmin, pmin);
+    _mm_storeu_ps(fmax, pmax);
+    _mm_storeu_pd(dsum, psum);
+    _mm_storeu_si128((__m128i *)ipass, pass);
+    for (int j = 0; j < SUBJECTS; ++j) {
+        _mm_storeu_ps(smn + j * 4, mn[j]);
+        _mm_storeu_ps(smx + j * 4, mx[j]);
+        _mm_storeu_pd(ds + j * 2, s[j]);
+        _mm_storeu_pd(dq + j * 2, q[j]);
+    }
+    stats_finish(st, 4, fmin, fmax, dsum, ipass, smn, smx, ds, dq, k, hi);
+    st->count = hi - lo;
+}
+
+__attribute__((target("avx2")))
+static void stats_avx2(int lo, int hi, ClassStats *st) {
+    __m256 pmin = _mm256_set1_ps(101.0f), pmax = _mm256_set1_ps(-1.0f), half = _mm256_set1_ps(50.0f);
+    __m256d psum = _mm256_setzero_pd();
+    __m256i pass = _mm256_setzero_si256();
+    __m256 mn[SUBJECTS], mx[SUBJECTS];
+    __m256d s[SUBJECTS], q[SUBJECTS];
+    for (int j = 0; j < SUBJECTS; ++j) { mn[j] = pmin; mx[j] = pmax; s[j] = q[j] = psum; }
+    int k = lo;
+    for (; k + 8 <= hi; k += 8) {
+        __m256 v = _mm256_loadu_ps(cols.pct + k);
+        pmin = _mm256_min_ps(pmin, v);
+        pmax = _mm256_max_ps(pmax, v);
+        psum = _mm256_add_pd(psum, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1))));
+        pass = _mm256_sub_epi32(pass, _mm256_castps_si256(_mm256_cmp_ps(v, half, _CMP_GE_OQ)));
+        for (int j = 0; j < SUBJECTS; ++j) {
+            __m256 m = _mm256_loadu_ps(cols.marks[j] + k);
+            __m256d a = _mm256_cvtps_pd(_mm256_castps256_ps128(m)), b = _mm256_cvtps_pd(_mm256_extractf128_ps(m, 1));
+            mn[j] = _mm256_min_ps(mn[j], m);
+            mx[j] = _mm256_max_ps(mx[j], m);
+            s[j] = _mm256_add_pd(s[j], _mm256_add_pd(a, b));
+            q[j] = _mm256_add_pd(q[j], _mm256_add_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b)));
+        }
+    }
+    float fmin[8], fmax[8], smn[SUBJECTS * 8], smx[SUBJECTS * 8];
+    double dsum[4], ds[SUBJECTS * 4], dq[SUBJECTS * 4];
+    int ipass[8];
+    _mm256_storeu_ps(fmin, pmin);
+    _mm256_storeu_ps(fmax, pmax);
+    _mm256_storeu_pd(dsum, psum);
+    _mm256_storeu_si256((__m256i *)ipass, pass);
+    for (int j = 0; j < SUBJECTS; ++j) {
+        _mm256_storeu_ps(smn + j * 8, mn[j]);
+        _mm256_storeu_ps(smx + j * 8, mx[j]);
+        _mm256_storeu_pd(ds + j * 4, s[j]);
+        _mm256_storeu_pd(dq + j * 4, q[j]);
+    }
+    stats_finish(st, 8, fmin, fmax, dsum, ipass, smn, smx, ds, dq, k, hi);
+    st->count = hi - lo;
+}
+#endif
+
+typedef void (*StatsKernel)(int lo, int hi, ClassStats *st);
+static StatsKernel statsKernel = NULL;
+
+static StatsKernel pick_stats_kernel(void) {
+#if SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return stats_avx2;
+    return stats_sse2;
+#else
+    return stats_scalar;
+#endif
+}
+
+typedef struct {
+    int lo, hi;
+    ClassStats st;
+} StatsJob;
+
+static void *stats_worker(void *arg) {
+    StatsJob *job = arg;
+    statsKernel(job->lo, job->hi, &job->st);
+    return NULL;
+}
+
+/* Earliest table slots holding the minimum and maximum percentage. */
+static void stats_find_slots(ClassStats *st) {
+    int lo = INT_MAX, hi = INT_MAX, k = 0;
+#if SIMD_X86
+    /* skip four rows at a time until one holds either value */
+    __m128 vmin = _mm_set1_ps(st->pctMin), vmax = _mm_set1_ps(st->pctMax);
+    for (; k + 4 <= cols.count; k += 4) {
+        __m128 v = _mm_loadu_ps(cols.pct + k);
+        if (!_mm_movemask_ps(_mm_or_ps(_mm_cmpeq_ps(v, vmin), _mm_cmpeq_ps(v, vmax)))) continue;
+        for (int i = k; i < k + 4; ++i) {
+            if (cols.pct[i] == st->pctMin && cols.slot[i] < lo) lo = cols.slot[i];
+            if (cols.pct[i] == st->pctMax && cols.slot[i] < hi) hi = cols.slot[i];
+        }
+    }
+#endif
+    for (; k < cols.count; ++k) {
+        float v = cols.pct[k];
+        if (v != st->pctMin && v != st->pctMax) continue;
+        if (v == st->pctMin && cols.slot[k] < lo) lo = cols.slot[k];
+        if (v == st->pctMax && cols.slot[k] < hi) hi = cols.slot[k];
+    }
+    st->minSlot = lo;
+    st->maxSlot = hi;
+}
+
+/* Summary of the live rows; returns 0 when there are none. */
+int class_stats(ClassStats *out) {
+    stats_init(out);
+    if (!cols_ready() || cols.count == 0) return 0;
+    if (!statsKernel) statsKernel = pick_stats_kernel();
+    int n = cols.count >= PARALLEL_STATS_MIN_ROWS ? worker_threads() : 1;
+    StatsJob jobs[MAX_WORKERS];
+    for (int t = 0; t < n; ++t) {
+        jobs[t].lo = (int)((long long)cols.count * t / n);
+        jobs[t].hi = (int)((long long)cols.count * (t + 1) / n);
+    }
+    run_workers(stats_worker, jobs, sizeof(StatsJob), n);
+    for (int t = 0; t < n; ++t) stats_merge(out, &jobs[t].st);
+    stats_find_slots(out);
+    return 1;
+}
+
+/* ---- Name index ---- */
+/* Trigram inverted index over case-folded names. A partial-name query looks
+   up the rarest trigram of the query and verifies only the rows on that list.
+   It is built on the first name search and then kept up to date: inserts
+   append, renames add the new trigrams, and deletes leave stale entries that
+   the verification step filters out. Anything that moves rows (compaction,
+   reload, saving a sort) just drops the index. */
+#define TRIGRAM_USED 0x80000000u
+
+static unsigned trigram_code(const char *p) {
+    return TRIGRAM_USED | ((unsigned)tolower((unsigned char)p[0]) << 16) |
+           ((unsigned)tolower((unsigned char)p[1]) << 8) |
+           (unsigned)tolower((unsigned char)p[2]);
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/* Distinct trigrams of a string, sorted; out needs MAX_NAME entries. */
+static int name_trigrams(const char *name, unsigned *out) {
+    size_t len = strlen(name);
+    if (len < 3) return 0;
+    if (len > MAX_NAME - 1) len = MAX_NAME - 1;
+    int n = 0;
+    for (size_t i = 0; i + 3 <= len; ++i) {
+        /* insertion sort: names are short */
+        unsigned c = trigram_code(name + i);
+        int j = n++;
+        while (j > 0 && out[j - 1] > c) { out[j] = out[j - 1]; j--; }
+        out[j] = c;
+    }
+    int w = 0;
+    for (int i = 0; i < n; ++i) if (w == 0 || out[w - 1] != out[i]) out[w++] = out[i];
+    return w;
+}
+
+static TrigramList *name_index_find(unsigned code) {
+    if (nameIndexCap == 0) return NULL;
+    unsigned h = roll_hash((int)code, nameIndexCap);
+    while (nameIndex[h].key) {
+        if (nameIndex[h].key == code) return &nameIndex[h];
+        h = (h + 1) & (unsigned)(nameIndexCap - 1);
+    }
+    return NULL;
+}
+
+static int name_index_resize(int cap) {
+    TrigramList *fresh = calloc((size_t)cap, sizeof(TrigramList));
+    if (!fresh) return 0;
+    for (int i = 0; i < nameIndexCap; ++i) {
+        if (!nameIndex[i].key) continue;
+        unsigned h = roll_hash((int)nameIndex[i].key, cap);
+        while (fresh[h].key) h = (h + 1) & (unsigned)(cap - 1);
+        fresh[h] = nameIndex[i];
+    }
+    free(nameIndex);
+    nameIndex = fresh;
+    nameIndexCap = cap;
+    return 1;
+}
+
+/* Posting list for a trigram, created empty if missing. */
+static TrigramList *name_index_slot(unsigned code) {
+    TrigramList *t = name_index_find(code);
+    if (t) return t;
+    if ((nameIndexUsed + 1) * 2 > nameIndexCap && !name_index_resize(nameIndexCap ? nameIndexCap * 2 : 1024)) return NULL;
+    unsigned h = roll_hash((int)code, nameIndexCap);
+    while (nameIndex[h].key) h = (h + 1) & (unsigned)(nameIndexCap - 1);
+    nameIndex[h].key = code;
+    nameIndexUsed++;
+    return &nameIndex[h];
+}
+
+static int posting_push(TrigramList *t, int idx) {
+    if (t->count == t->cap) {
+        int cap = t->cap ? t->cap * 2 : 4;
+        int *ids = realloc(t->ids, (size_t)cap * sizeof(int));
+        if (!ids) return 0;
+        t->ids = ids;
+        t->cap = cap;
+    }
+    t->ids[t->count++] = idx;
+    return 1;
+}
+
+void name_index_drop(void) {
+    for (int i = 0; i < nameIndexCap; ++i) free(nameIndex[i].ids);
+    free(nameIndex);
+    nameIndex = NULL;
+    nameIndexCap = nameIndexUsed = 0;
+    nameIndexStale = 0;
+    nameIndexBuilt = 0;
+}
+
+/* Two passes: size every posting list exactly, then fill in table order. */
+int name_index_rebuild(void) {
+    name_index_drop();
+    unsigned codes[MAX_NAME];
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < studentCount; ++i) {
+            if (studentDead[i]) continue;
+            int n = name_trigrams(studentTable[i].name, codes);
+            for (int k = 0; k < n; ++k) {
+                TrigramList *t = pass == 0 ? name_index_slot(codes[k]) : name_index_find(codes[k]);
+                if (!t) { name_index_drop(); return 0; }
+                if (pass == 0) t->cap++;
+                else t->ids[t->count++] = i;
+            }
+        }
+        for (int j = 0; pass == 0 && j < nameIndexCap; ++j) {
+            if (!nameIndex[j].key) continue;
+            nameIndex[j].ids = malloc((size_t)nameIndex[j].cap * sizeof(int));
+            if (!nameIndex[j].ids) { name_index_drop(); return 0; }
+        }
+    }
+    nameIndexBuilt = 1;
+    return 1;
+}
+
+/* Index a new row, or the new name of an edited row (oldName != NULL). */
+void name_index_add(int idx, const char *oldName) {
+    if (!nameIndexBuilt) return;
+    unsigned codes[MAX_NAME], old[MAX_NAME];
+    int n = name_trigrams(studentTable[idx].name, codes);
+    int m = oldName ? name_trigrams(oldName, old) : 0;
+    for (int k = 0, j = 0; k < n; ++k) {
+        while (j < m && old[j] < codes[k]) j++;
+        if (j < m && old[j] == codes[k]) continue; /* already listed */
+        TrigramList *t = name_index_slot(codes[k]);
+        if (!t || !posting_push(t, idx)) { name_index_drop(); return; }
+    }
+    if (m) nameIndexStale++;
+}
+
+/* The row's postings stay behind; verification skips dead rows. Past one
+   stale row per live one the index is cheaper to rebuild than to scan. */
+void name_index_forget(void) {
+    if (nameIndexBuilt && ++nameIndexStale > table_live_count()) name_index_drop();
+}
+
+/* Rows whose name contains q, in table order, into *out (caller frees).
+   Returns -1 when the query is too short to use the index. */
+int name_index_search(const char *q, int **out) {
+    unsigned codes[MAX_NAME];
+    int n = name_trigrams(q, codes);
+    *out = NULL;
+    if (n == 0 || strlen(q) > MAX_NAME - 1) return -1;
+    if (!nameIndexBuilt && !name_index_rebuild()) return -1;
+    TrigramList *best = NULL;
+    for (int k = 0; k < n; ++k) {
+        TrigramList *t = name_index_find(codes[k]);
+        if (!t || t->count == 0) return 0;
+        if (!best || t->count < best->count) best = t;
+    }
+    int *ids = malloc((size_t)best->count * sizeof(int));
+    if (!ids) return -1;
+    memcpy(ids, best->ids, (size_t)best->count * sizeof(int));
+    /* renames can append out of order or list a row twice */
+    qsort(ids, best->count, sizeof(int), cmp_int);
+    int w = 0;
+    for (int i = 0; i < best->count; ++i) {
+        int idx = ids[i];
+        if (w && ids[w - 1] == idx) continue;
+        if (studentDead[idx] || !contains_case_insensitive(studentTable[idx].name, q)) continue;
+        ids[w++] = idx;
+    }
+    *out = ids;
+    return w;
+}
+
+/* ---- Percentage index ---- */
+/* Live rows sorted by (percentage, table slot), built on first use and then
+   kept sorted through inserts, edits and deletes with a binary search and
+   one memmove each. A percentage range is two binary searches and the span
+   between them; the top or bottom of the class is either end of the array. */
+static int pct_entry_less(float pa, int ia, float pb, int ib) {
+    return pa < pb || (pa == pb && ia < ib);
+}
+
+static int cmp_pct_entry(const void *a, const void *b) {
+    const PctEntry *x = a, *y = b;
+    if (pct_entry_less(x->pct, x->idx, y->pct, y->idx)) return -1;
+    return pct_entry_less(y->pct, y->idx, x->pct, x->idx);
+}
+
+/* Highest percentage first, earliest slot first among equals. */
+static int cmp_pct_entry_high(const void *a, const void *b) {
+    const PctEntry *x = a, *y = b;
+    if (x->pct != y->pct) return x->pct < y->pct ? 1 : -1;
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+/* First entry not below (pct, idx). */
+static int pct_index_lower(float pct, int idx) {
+    int lo = 0, hi = pctIndexCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (pct_entry_less(pctIndex[mid].pct, pctIndex[mid].idx, pct, idx)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void pct_index_drop(void) {
+    free(pctIndex);
+    pctIndex = NULL;
+    pctIndexCount = pctIndexCap = 0;
+    pctIndexBuilt = 0;
+}
+
+int pct_index_rebuild(void) {
+    pct_index_drop();
+    if (!cols_ready()) return 0;
+    int cap = cols.count + 16;
+    pctIndex = malloc((size_t)cap * sizeof(PctEntry));
+    if (!pctIndex) return 0;
+    pctIndexCap = cap;
+    for (int k = 0; k < cols.count; ++k) {
+        pctIndex[k].pct = cols.pct[k];
+        pctIndex[k].idx = cols.slot[k];
+    }
+    pctIndexCount = cols.count;
+    qsort(pctIndex, pctIndexCount, sizeof(PctEntry), cmp_pct_entry);
+    pctIndexBuilt = 1;
+    return 1;
+}
+
+void pct_index_add(int idx) {
+    if (!pctIndexBuilt) return;
+    if (pctIndexCount == pctIndexCap) {
+        int cap = pctIndexCap * 2;
+        PctEntry *grown = realloc(pctIndex, (size_t)cap * sizeof(PctEntry));
+        if (!grown) { pct_index_drop(); return; }
+        pctIndex = grown;
+        pctIndexCap = cap;
+    }
+    float pct = studentTable[idx].percentage;
+    int at = pct_index_lower(pct, idx);
+    memmove(pctIndex + at + 1, pctIndex + at, (size_t)(pctIndexCount - at) * sizeof(PctEntry));
+    pctIndex[at].pct = pct;
+    pctIndex[at].idx = idx;
+    pctIndexCount++;
+}
+
+/* Remove the entry of a row that had percentage pct. */
+void pct_index_remove(int idx, float pct) {
+    if (!pctIndexBuilt) return;
+    int at = pct_index_lower(pct, idx);
+    if (at == pctIndexCount || pctIndex[at].idx != idx) return;
+    memmove(pctIndex + at, pctIndex + at + 1, (size_t)(pctIndexCount - at - 1) * sizeof(PctEntry));
+    pctIndexCount--;
+}
+
+/* Entries with lo <= percentage <= hi are pctIndex[*first .. *first + count). */
+int pct_index_range(float lo, float hi, int *first) {
+    *first = 0;
+    if (!pctIndexBuilt && !pct_index_rebuild()) return -1;
+    if (!(lo <= hi)) return 0;
+    int a = pct_index_lower(lo, INT_MIN);
+    int b = pct_index_lower(hi, INT_MAX); /* no slot is INT_MAX */
+    *first = a;
+    return b - a;
+}
+
+/* ---- Rank index ---- */
+/* Rank and percentile of a row without sorting: a Fenwick tree counts live
+   rows per bucket of 0.01 total marks (the precision totals are shown at),
+   so "how many rows score below this total" is a prefix sum in O(log n).
+   Ranks therefore resolve totals to 0.01: two totals that print the same
+   share a rank. Built on first use and kept current by the table hooks. */
+
+/* v in hundredths, clamped to [0, top], rounded half to even in double like
+   "%.2f", so a value lands in the bucket it is printed as. */
+static int hundredths_bucket(float v, int top) {
+    double scaled = (double)v * 100.0;  /* exact for any float */
+    if (!(scaled > 0.0)) return 0;
+    if (scaled >= top) return top;
+    int c = (int)scaled;
+    double rest = scaled - c;
+    if (rest > 0.5 || (rest == 0.5 && (c & 1))) c++;
+    return c;
+}
+
+static int rank_bucket(float total) {
+    return hundredths_bucket(total, RANK_BUCKETS - 1);
+}
+
+void rank_tree_drop(void) {
+    free(rankTree);
+    rankTree = NULL;
+    rankTreeBuilt = 0;
+}
+
+int rank_tree_rebuild(void) {
+    rank_tree_drop();
+    if (!cols_ready()) return 0;
+    rankTree = calloc(RANK_BUCKETS + 1, sizeof(int));
+    if (!rankTree) return 0;
+    for (int pos = 0; pos < cols.count; ++pos) rankTree[rank_bucket(cols.total[pos]) + 1]++;
+    /* linear build: push each node's sum to its parent */
+    for (int i = 1; i <= RANK_BUCKETS; ++i) {
+        int parent = i + (i & -i);
+        if (parent <= RANK_BUCKETS) rankTree[parent] += rankTree[i];
+    }
+    rankTreeBuilt = 1;
+    return 1;
+}
+
+void rank_tree_add(float total, int delta) {
+    if (!rankTreeBuilt) return;
+    for (int i = rank_bucket(total) + 1; i <= RANK_BUCKETS; i += i & -i) rankTree[i] += delta;
+}
+
+/* Live rows in buckets [0, bucket). */
+static int rank_tree_count_below(int bucket) {
+    int n = 0;
+    for (int i = bucket; i > 0; i -= i & -i) n += rankTree[i];
+    return n;
+}
+
+/* Rank of a live row by total marks (1 = best, ties share a rank) and the
+   number of rows scoring below it; 0 if the index cannot be built. */
+int class_rank(int idx, int *rank, int *below) {
+    if (!rankTreeBuilt && !rank_tree_rebuild()) return 0;
+    int b = rank_bucket(studentTable[idx].total);
+    *below = rank_tree_count_below(b);
+    *rank = table_live_count() - rank_tree_count_below(b + 1) + 1;
+    return 1;
+}
+
+/* "Class Rank: 3 of 120 (percentile 98.3)"; the percentile is the share of
+   the class scoring at or below this row. */
+void print_class_rank(int idx) {
+    int rank, below, n = table_live_count();
+    if (!class_rank(idx, &rank, &below)) return;
+    int atOrBelow = n - rank + 1;
+    printf("Class Rank: %d of %d (percentile %.1f, ahead of %d)\n", rank, n, 100.0 * atOrBelow / n, below);
+}
+
+/* ---- Grade bitmaps ---- */
+/* Sets of table slots as compressed bitmaps: slots are split into chunks of
+   65536 by their high bits, a chunk holding at most BM_ARRAY_MAX slots keeps
+   them as a sorted array of low halves and fuller chunks switch to a plain
+   bitset. Missing chunks are empty. AND/OR work chunk by chunk on 64-bit
+   words, so combining filters never rescans the table. One bitmap per grade
+   is built on first use and kept current by the table hooks. */
+static int popcount64(unsigned long long w) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(w);
+#else
+    int n = 0;
+    while (w) { w &= w - 1; n++; }
+    return n;
+#endif
+}
+
+static int ctz64(unsigned long long w) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    while (!(w & 1)) { w >>= 1; n++; }
+    return n;
+#endif
+}
+
+static void bm_chunk_free(BmChunk *c) {
+    free(c->arr);
+    free(c->bits);
+    c->arr = NULL;
+    c->bits = NULL;
+}
+
+void bm_free(Bitmap *b) {
+    for (int i = 0; i < b->count; ++i) bm_chunk_free(&b->chunks[i]);
+    free(b->chunks);
+    b->chunks = NULL;
+    b->count = b->cap = 0;
+}
+
+/* Index of the chunk for key, or where it would be inserted (*found = 0). */
+static int bm_find(const Bitmap *b, unsigned key, int *found) {
+    int lo = 0, hi = b->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (b->chunks[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = lo < b->count && b->chunks[lo].key == key;
+    return lo;
+}
+
+static BmChunk *bm_insert_chunk(Bitmap *b, int at, unsigned key) {
+    if (b->count == b->cap) {
+        int cap = b->cap ? b->cap * 2 : 4;
+        BmChunk *grown = realloc(b->chunks, (size_t)cap * sizeof(BmChunk));
+        if (!grown) return NULL;
+        b->chunks = grown;
+        b->cap = cap;
+    }
+    memmove(b->chunks + at + 1, b->chunks + at, (size_t)(b->count - at) * sizeof(BmChunk));
+    b->count++;
+    memset(&b->chunks[at], 0, sizeof(BmChunk));
+    b->chunks[at].key = key;
+    return &b->chunks[at];
+}
+
+static void bm_remove_chunk(Bitmap *b, int at) {
+    bm_chunk_free(&b->chunks[at]);
+    memmove(b->chunks + at, b->chunks + at + 1, (size_t)(b->count - at - 1) * sizeof(BmChunk));
+    b->count--;
+}
+
+/* Array chunk -> bitset chunk. */
+static int bm_to_bits(BmChunk *c) {
+    unsigned long long *bits = calloc(BM_CHUNK_WORDS, sizeof(unsigned long long));
+    if (!bits) return 0;
+    for (int i = 0; i < c->card; ++i) bits[c->arr[i] >> 6] |= 1ull << (c->arr[i] & 63);
+    free(c->arr);
+    c->arr = NULL;
+    c->arrCap = 0;
+    c->bits = bits;
+    return 1;
+}
+
+/* Bitset chunk -> array chunk; card must already be small. */
+static int bm_to_array(BmChunk *c) {
+    unsigned short *arr = malloc((size_t)(c->card ? c->card : 1) * sizeof(unsigned short));
+    if (!arr) return 0;
+    int n = 0;
+    for (int w = 0; w < BM_CHUNK_WORDS; ++w)
+        for (unsigned long long word = c->bits[w]; word; word &= word - 1)
+            arr[n++] = (unsigned short)(w * 64 + ctz64(word));
+    free(c->bits);
+    c->bits = NULL;
+    c->arr = arr;
+    c->arrCap = c->card ? c->card : 1;
+    return 1;
+}
+
+int bm_set(Bitmap *b, int slot) {
+    int found, at = bm_find(b, (unsigned)slot >> 16, &found);
+    BmChunk *c = found ? &b->chunks[at] : bm_insert_chunk(b, at, (unsigned)slot >> 16);
+    if (!c) return 0;
+    unsigned short low = (unsigned short)(slot & 0xffff);
+    if (c->bits) {
+        unsigned long long bit = 1ull << (low & 63);
+        if (!(c->bits[low >> 6] & bit)) { c->bits[low >> 6] |= bit; c->card++; }
+        return 1;
+    }
+    int lo = 0, hi = c->card;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (c->arr[mid] < low) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < c->card && c->arr[lo] == low) return 1;
+    if (c->card == BM_ARRAY_MAX) return bm_to_bits(c) && bm_set(b, slot);
+    if (c->card == c->arrCap) {
+        int cap = c->arrCap ? c->arrCap * 2 : 8;
+        if (cap > BM_ARRAY_MAX) cap = BM_ARRAY_MAX;
+        unsigned short *grown = realloc(c->arr, (size_t)cap * sizeof(unsigned short));
+        if (!grown) return 0;
+        c->arr = grown;
+        c->arrCap = cap;
+    }
+    memmove(c->arr + lo + 1, c->arr + lo, (size_t)(c->card - lo) * sizeof(unsigned short));
+    c->arr[lo] = low;
+    c->card++;
+    return 1;
+}
+
+void bm_clear(Bitmap *b, int slot) {
+    int found, at = bm_find(b, (unsigned)slot >> 16, &found);
+    if (!found) return;
+    BmChunk *c = &b->chunks[at];
+    unsigned short low = (unsigned short)(slot & 0xffff);
+    if (c->bits) {
+        unsigned long long bit = 1ull << (low & 63);
+        if (!(c->bits[low >> 6] & bit)) return;
+        c->bits[low >> 6] &= ~bit;
+        c->card--;
+        /* shrink with some slack so a slot toggling at the limit does not thrash */
+        if (c->card <= BM_ARRAY_MAX / 2) bm_to_array(c);
+    } else {
+        int i = 0;
+        while (i < c->card && c->arr[i] < low) i++;
+        if (i == c->card || c->arr[i] != low) return;
+        memmove(c->arr + i, c->arr + i + 1, (size_t)(c->card - i - 1) * sizeof(unsigned short));
+        c->card--;
+    }
+    if (c->card == 0) bm_remove_chunk(b, at);
+}
+
+/* Dense words of a chunk, expanding an array chunk into tmp. */
+static const unsigned long long *bm_words(const BmChunk *c, unsigned long long *tmp) {
+    if (c->bits) return c->bits;
+    memset(tmp, 0, BM_CHUNK_WORDS * sizeof(unsigned long long));
+    for (int i = 0; i < c->card; ++i) tmp[c->arr[i] >> 6] |= 1ull << (c->arr[i] & 63);
+    return tmp;
+}
+
+/* Append the result of combining two chunks (either may be NULL for OR). */
+static int bm_emit(Bitmap *out, unsigned key, const BmChunk *x, const BmChunk *y, int isAnd) {
+    static unsigned long long tx[BM_CHUNK_WORDS], ty[BM_CHUNK_WORDS];
+    unsigned long long *bits = malloc(BM_CHUNK_WORDS * sizeof(unsigned long long));
+    if (!bits) return 0;
+    const unsigned long long *wx = x ? bm_words(x, tx) : NULL;
+    const unsigned long long *wy = y ? bm_words(y, ty) : NULL;
+    int card = 0;
+    for (int w = 0; w < BM_CHUNK_WORDS; ++w) {
+        unsigned long long a = wx ? wx[w] : 0, b = wy ? wy[w] : 0;
+        bits[w] = isAnd ? (a & b) : (a | b);
+        card += popcount64(bits[w]);
+    }
+    if (card == 0) { free(bits); return 1; }
+    BmChunk *c = bm_insert_chunk(out, out->count, key);
+    if (!c) { free(bits); return 0; }
+    c->bits = bits;
+    c->card = card;
+    return card > BM_ARRAY_MAX || bm_to_array(c);
+}
+
+/* out = x AND y, or x OR y; out must be empty and distinct from both. */
+int bm_combine(const Bitmap *x, const Bitmap *y, Bitmap *out, int isAnd) {
+    int i = 0, j = 0;
+    while (i < x->count || j < y->count) {
+        unsigned kx = i < x->count ? x->chunks[i].key : UINT_MAX;
+        unsigned ky = j < y->count ? y->chunks[j].key : UINT_MAX;
+        const BmChunk *cx = kx <= ky ? &x->chunks[i] : NULL;
+        const BmChunk *cy = ky <= kx ? &y->chunks[j] : NULL;
+        if (cx) i++;
+        if (cy) j++;
+        if (isAnd && !(cx && cy)) continue;
+        if (!bm_emit(out, cx ? kx : ky, cx, cy, isAnd)) { bm_free(out); return 0; }
+    }
+    return 1;
+}
+
+/* Set slots in ascending order into *out (caller frees); returns the count. */
+int bm_slots(const Bitmap *b, int **out) {
+    int total = 0;
+    for (int i = 0; i < b->count; ++i) total += b->chunks[i].card;
+    *out = malloc((size_t)(total ? total : 1) * sizeof(int));
+    if (!*out) return -1;
+    int n = 0;
+    for (int i = 0; i < b->count; ++i) {
+        const BmChunk *c = &b->chunks[i];
+        int base = (int)(c->key << 16);
+        if (!c->bits) {
+            for (int k = 0; k < c->card; ++k) (*out)[n++] = base + c->arr[k];
+            continue;
+        }
+        for (int w = 0; w < BM_CHUNK_WORDS; ++w)
+            for (unsigned long long word = c->bits[w]; word; word &= word - 1)
+                (*out)[n++] = base + w * 64 + ctz64(word);
+    }
+    return n;
+}
+
+void grade_bitmaps_drop(void) {
+    for (int g = 0; g < GRADE_COUNT; ++g) bm_free(&gradeBitmaps[g]);
+    gradeBitmapsBuilt = 0;
+}
+
+int grade_bitmaps_rebuild(void) {
+    grade_bitmaps_drop();
+    for (int i = 0; i < studentCount; ++i)
+        if (!studentDead[i] && !bm_set(&gradeBitmaps[studentTable[i].grade], i)) { grade_bitmaps_drop(); return 0; }
+    gradeBitmapsBuilt = 1;
+    return 1;
+}
+
+void grade_bitmaps_set(int idx, int grade, int on) {
+    if (!gradeBitmapsBuilt) return;
+    if (!on) bm_clear(&gradeBitmaps[grade], idx);
+    else if (!bm_set(&gradeBitmaps[grade], idx)) grade_bitmaps_drop();
+}
+
+/* Grade from its label, case-insensitive; -1 if unknown. */
+int grade_from_label(const char *label) {
+    for (int g = 0; g < GRADE_COUNT; ++g)
+        if (portable_strcasecmp(gradeNames[g], label) == 0) return g;
+    return -1;
+}
+
+/* One filter term, "grade=B", "name=ra" or "pct=60-75", as a bitmap of slots. */
+static int filter_term(const char *key, const char *value, Bitmap *out) {
+    if (portable_strcasecmp(key, "grade") == 0) {
+        int g = grade_from_label(value);
+        if (g < 0) return 0;
+        if (!gradeBitmapsBuilt && !grade_bitmaps_rebuild()) return 0;
+        Bitmap none = {0};
+        return bm_combine(&gradeBitmaps[g], &none, out, 0);
+    }
+    if (portable_strcasecmp(key, "name") == 0) {
+        int *ids;
+        int m = name_index_search(value, &ids);
+        if (m < 0) {
+            for (int i = 0; i < studentCount; ++i)
+                if (!studentDead[i] && contains_case_insensitive(studentTable[i].name, value) && !bm_set(out, i)) return 0;
+            return 1;
+        }
+        for (int k = 0; k < m; ++k) if (!bm_set(out, ids[k])) { free(ids); return 0; }
+        free(ids);
+        return 1;
+    }
+    if (portable_strcasecmp(key, "pct") == 0) {
+        float lo, hi;
+        if (sscanf(value, "%f-%f", &lo, &hi) != 2) return 0;
+        int first, m = pct_index_range(lo, hi, &first);
+        if (m < 0) return 0;
+        for (int k = first; k < first + m; ++k) if (!bm_set(out, pctIndex[k].idx)) return 0;
+        return 1;
+    }
+    return 0;
+}
+
+/* Evaluate "term [and|or term]..." with AND binding tighter than OR.
+   Values may be quoted to include spaces: name='ra j'. */
+int filter_eval(const char *expr, Bitmap *out) {
+    Bitmap acc = {0}, group = {0};
+    int haveGroup = 0, ok = 1, expectTerm = 1;
+    const char *p = expr;
+    while (ok) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (!*p) break;
+        char word[128];
+        int n = 0;
+        if (!expectTerm) {
+            while (*p && *p != ' ' && *p != '\t' && n < (int)sizeof(word) - 1) word[n++] = *p++;
+            word[n] = '\0';
+            if (portable_strcasecmp(word, "or") == 0) {
+                Bitmap merged = {0};
+                ok = bm_combine(&acc, &group, &merged, 0);
+                bm_free(&acc);
+                bm_free(&group);
+                acc = merged;
+                haveGroup = 0;
+            } else if (portable_strcasecmp(word, "and") != 0) {
+                ok = 0;
+            }
+            expectTerm = 1;
+            continue;
+        }
+        char key[16], value[128];
+        while (*p && *p != '=' && *p != ' ' && n < (int)sizeof(key) - 1) key[n++] = *p++;
+        key[n] = '\0';
+        if (*p != '=') { ok = 0; break; }
+        p++;
+        n = 0;
+        char quote = (*p == '\'' || *p == '"') ? *p++ : 0;
+        while (*p && (quote ? *p != quote : (*p != ' ' && *p != '\t')) && n < (int)sizeof(value) - 1) value[n++] = *p++;
+        value[n] = '\0';
+        if (quote && *p == quote) p++;
+        Bitmap term = {0};
+        if (!filter_term(key, value, &term)) { bm_free(&term); ok = 0; break; }
+        if (haveGroup) {
+            Bitmap both = {0};
+            ok = bm_combine(&group, &term, &both, 1);
+            bm_free(&group);
+            bm_free(&term);
+            group = both;
+        } else {
+            group = term;
+            haveGroup = 1;
+        }
+        expectTerm = 0;
+    }
+    if (ok && expectTerm) ok = 0; /* empty filter or trailing and/or */
+    if (ok) ok = bm_combine(&acc, &group, out, 0);
+    bm_free(&acc);
+    bm_free(&group);
+    return ok;
+}
+
+/* ---- Running statistics ---- */
+/* Class totals updated by every insert, edit and delete, so the statistics
+   screen and the principal's dashboard read them instead of scanning. Sums
+   are exact enough in doubles; they are re-derived from the columns whenever
+   slots move (table_rebuild_indexes) to shed any drift.
+
+   The extremes live in order structures so a delete never forces a rescan.
+   Each subject has a Fenwick tree counting rows per 0.01 mark; its lowest
+   and highest non-empty buckets are the subject's min and max in O(log n).
+   Buckets round like "%.2f", so the screen shows the exact extremes. The
+   percentage min and max also need the earliest slot holding them, so they
+   come from a min-heap and a max-heap of (percentage, slot). Deletes and
+   edits leave the old entry behind; a heap top whose row is gone or changed
+   is popped when the extremes are read, and a heap that grows past twice
+   the class is filtered and deduplicated in place. */
+static int mark_bucket(float m) {
+    return hundredths_bucket(m, MARK_BUCKETS - 1);
+}
+
+static void mark_tree_add(int *tree, int bucket, int delta) {
+    for (int i = bucket + 1; i <= MARK_BUCKETS; i += i & -i) tree[i] += delta;
+}
+
+/* Bucket of the k-th lowest mark, k from 1, by descending the tree. */
+static int mark_tree_kth(const int *tree, int k) {
+    int step = 1, pos = 0;
+    while (step * 2 <= MARK_BUCKETS) step *= 2;
+    for (; step; step >>= 1) {
+        if (pos + step <= MARK_BUCKETS && tree[pos + step] < k) {
+            pos += step;
+            k -= tree[pos];
+        }
+    }
+    return pos;
+}
+
+static int slot_heap_before(const SlotHeap *h, const PctEntry *a, const PctEntry *b) {
+    if (a->pct != b->pct) return h->high ? a->pct > b->pct : a->pct < b->pct;
+    return a->idx < b->idx;
+}
+
+static void slot_heap_sift_down(SlotHeap *h, int i) {
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= h->count) return;
+        if (c + 1 < h->count && slot_heap_before(h, &h->e[c + 1], &h->e[c])) c++;
+        if (!slot_heap_before(h, &h->e[c], &h->e[i])) return;
+        PctEntry t = h->e[i]; h->e[i] = h->e[c]; h->e[c] = t;
+        i = c;
+    }
+}
+
+static int slot_heap_push(SlotHeap *h, float pct, int idx) {
+    if (h->count == h->cap) {
+        int cap = h->cap ? h->cap * 2 : 64;
+        PctEntry *grown = realloc(h->e, (size_t)cap * sizeof(PctEntry));
+        if (!grown) return 0;
+        h->e = grown;
+        h->cap = cap;
+    }
+    PctEntry v = {pct, idx};
+    int i = h->count++;
+    while (i > 0 && slot_heap_before(h, &v, &h->e[(i - 1) / 2])) { h->e[i] = h->e[(i - 1) / 2]; i = (i - 1) / 2; }
+    h->e[i] = v;
+    return 1;
+}
+
+static void slot_heap_pop(SlotHeap *h) {
+    h->e[0] = h->e[--h->count];
+    slot_heap_sift_down(h, 0);
+}
+
+/* The entry still describes a live row. */
+static int slot_entry_live(const PctEntry *e) {
+    return e->idx < studentCount && !studentDead[e->idx] && studentTable[e->idx].percentage == e->pct;
+}
+
+/* Drop stale and repeated entries, then restore the heap order. */
+static void slot_heap_compact(SlotHeap *h) {
+    int w = 0;
+    for (int k = 0; k < h->count; ++k) if (slot_entry_live(&h->e[k])) h->e[w++] = h->e[k];
+    /* a slot edited away from a value and back has two live entries: sort
+       in heap order (a sorted array is a heap) and keep one of each */
+    qsort(h->e, w, sizeof(PctEntry), h->high ? cmp_pct_entry_high : cmp_pct_entry);
+    int u = 0;
+    for (int k = 0; k < w; ++k)
+        if (u == 0 || h->e[k].pct != h->e[u - 1].pct || h->e[k].idx != h->e[u - 1].idx) h->e[u++] = h->e[k];
+    h->count = u;
+}
+
+static void slot_heap_settle(SlotHeap *h) {
+    while (h->count && !slot_entry_live(&h->e[0])) slot_heap_pop(h);
+}
+
+
+static void running_stats_apply(int idx, int sign) {
+    const Student *s = &studentTable[idx];
+    runStats.count += sign;
+    runStats.pctSum += sign * (double)s->percentage;
+    runStats.pass += s->percentage >= 50.0f ? sign : 0;
+    runStats.gradeCount[s->grade] += sign;
+    for (int j = 0; j < SUBJECTS; ++j) {
+        double m = s->marks[j];
+        runStats.sum[j] += sign * m;
+        runStats.sumSq[j] += sign * m * m;
+        mark_tree_add(runStats.markTree[j], mark_bucket(s->marks[j]), sign);
+    }
+    /* a removed row's heap entries go stale and are dropped lazily */
+    SlotHeap *heaps[2] = {&runStats.pctLow, &runStats.pctHigh};
+    for (int k = 0; k < 2; ++k) {
+        if (sign > 0 && !slot_heap_push(heaps[k], s->percentage, idx)) { running_stats_free(); return; }
+        if (heaps[k]->count > 2 * runStats.count + 64) slot_heap_compact(heaps[k]);
+    }
+}
+
+void running_stats_add(int idx) {
+    if (runStats.valid) running_stats_apply(idx, 1);
+}
+
+void running_stats_remove(int idx) {
+    if (runStats.valid) running_stats_apply(idx, -1);
+}
+
+void running_stats_free(void) {
+    free(runStats.pctLow.e);
+    free(runStats.pctHigh.e);
+    for (int j = 0; j < SUBJECTS; ++j) free(runStats.markTree[j]);
+    memset(&runStats, 0, sizeof(runStats));
+}
+
+/* Re-derive every total from the columns in one class_stats() pass and
+   rebuild the extreme structures from the columns. */
+int running_stats_rebuild(void) {
+    ClassStats st;
+    running_stats_free();
+    if (!class_stats(&st) && (!cols.valid || cols.count)) return 0;
+    int cap = cols.count + 64;
+    runStats.pctLow.e = malloc((size_t)cap * sizeof(PctEntry));
+    runStats.pctHigh.e = malloc((size_t)cap * sizeof(PctEntry));
+    int ok = runStats.pctLow.e && runStats.pctHigh.e;
+    for (int j = 0; j < SUBJECTS; ++j) {
+        runStats.markTree[j] = calloc(MARK_BUCKETS + 1, sizeof(int));
+        if (!runStats.markTree[j]) ok = 0;
+    }
+    if (!ok) { running_stats_free(); return 0; }
+    runStats.pctLow.cap = runStats.pctHigh.cap = cap;
+    runStats.pctHigh.high = 1;
+    runStats.count = st.count;
+    runStats.pctSum = st.pctSum;
+    runStats.pass = st.pass;
+    for (int j = 0; j < SUBJECTS; ++j) {
+        runStats.sum[j] = st.sum[j];
+        runStats.sumSq[j] = st.sumSq[j];
+        int *tree = runStats.markTree[j];
+        for (int k = 0; k < cols.count; ++k) tree[mark_bucket(cols.marks[j][k]) + 1]++;
+        for (int i = 1; i <= MARK_BUCKETS; ++i) {
+            int parent = i + (i & -i);
+            if (parent <= MARK_BUCKETS) tree[parent] += tree[i];
+        }
+    }
+    for (int k = 0; k < cols.count; ++k) {
+        runStats.gradeCount[cols.grade[k]]++;
+        PctEntry e = {cols.pct[k], cols.slot[k]};
+        runStats.pctLow.e[k] = runStats.pctHigh.e[k] = e;
+    }
+    runStats.pctLow.count = runStats.pctHigh.count = cols.count;
+    for (int i = cols.count / 2 - 1; i >= 0; --i) {
+        slot_heap_sift_down(&runStats.pctLow, i);
+        slot_heap_sift_down(&runStats.pctHigh, i);
+    }
+    runStats.valid = 1;
+    return 1;
+}
+
+/* Totals ready to read, with the extremes read off the order structures. */
+int running_stats_ready(void) {
+    if (!runStats.valid && !running_stats_rebuild()) return 0;
+    slot_heap_settle(&runStats.pctLow);
+    slot_heap_settle(&runStats.pctHigh);
+    if (runStats.count == 0) {
+        runStats.pctMin = 101.0f;
+        runStats.pctMax = -1.0f;
+        runStats.minSlot = runStats.maxSlot = INT_MAX;
+        for (int j = 0; j < SUBJECTS; ++j) { runStats.min[j] = 101.0f; runStats.max[j] = -1.0f; }
+        return 1;
+    }
+    runStats.pctMin = runStats.pctLow.e[0].pct;
+    runStats.minSlot = runStats.pctLow.e[0].idx;
+    runStats.pctMax = runStats.pctHigh.e[0].pct;
+    runStats.maxSlot = runStats.pctHigh.e[0].idx;
+    for (int j = 0; j < SUBJECTS; ++j) {
+        runStats.min[j] = (float)mark_tree_kth(runStats.markTree[j], 1) / 100.0f;
+        runStats.max[j] = (float)mark_tree_kth(runStats.markTree[j], runStats.count) / 100.0f;
+    }
+    return 1;
+}
+
+/* Earliest table slots with the lowest and highest percentage. */
+int pct_extremes(int *minIdx, int *maxIdx) {
+    if (pctIndexBuilt && pctIndexCount > 0) {
+        *minIdx = pctIndex[0].idx;
+        *maxIdx = pctIndex[pct_index_lower(pctIndex[pctIndexCount - 1].pct, INT_MIN)].idx;
+        return 1;
+    }
+    if (!running_stats_ready() || runStats.count == 0) return 0;
+    *minIdx = runStats.minSlot;
+    *maxIdx = runStats.maxSlot;
+    return 1;
+}
+
+/* One-line class summary for the principal's menu, from the running totals. */
+void print_dashboard(void) {
+    if (!runStats.valid || runStats.count == 0) { printf("Students: 0\n\n"); return; }
+    printf("Students: %d  Average: %.2f%%  Pass rate: %.1f%%\nGrades:",
+           runStats.count, runStats.pctSum / runStats.count, 100.0 * runStats.pass / runStats.count);
+    for (int g = 0; g < GRADE_COUNT; ++g) printf(" %s=%d", gradeNames[g], runStats.gradeCount[g]);
+    printf("\nSubject means:");
+    for (int j = 0; j < SUBJECTS; ++j) printf(" %s %.2f", subjectNames[j], runStats.sum[j] / runStats.count);
+    printf("\n\n");
+}
+
+/* ---- Journal ---- */
+/* Write-ahead log of single-record edits, one line per entry:
+     A roll|name|m1|m2|m3   add a record
+     U roll|name|m1|m2|m3   replace the record with that roll
+     D roll                 delete the record with that roll
+   Entries are replayed over the base store on load and folded into it by
+   store_checkpoint(), so an edit costs one short append instead of a rewrite.
+   Each entry reaches the OS immediately; fsync is batched (group commit), so
+   a power loss can drop at most the last commit interval of edits (Windows
+   has no flusher thread and syncs every entry). Marks are written the way
+   the base store keeps them: two decimals for students.txt, exact floats
+   (%.9g) for the binary and B+tree stores, so replaying an entry yields the
+   same record a checkpoint would have written. */
+static void journal_lock(void) {
+#if !OS_WINDOWS
+    pthread_mutex_lock(&journalLock);
+#endif
+}
+
+static void journal_unlock(void) {
+#if !OS_WINDOWS
+    pthread_mutex_unlock(&journalLock);
+#endif
+}
+
+static void journal_sync_locked(void) {
+    if (journalFp && journalPending > 0) file_sync(journalFp);
+    journalPending = 0;
+    journalLastSync = time(NULL);
+}
+
+#if !OS_WINDOWS
+/* background half of the group commit: bounds how long an edit stays unsynced */
+static void *journal_flusher(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&journalLock);
+    while (!journalFlusherStop) {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += commitInterval;
+        pthread_cond_timedwait(&journalWake, &journalLock, &until);
+        if (!journalFlusherStop) journal_sync_locked();
+    }
+    pthread_mutex_unlock(&journalLock);
+    return NULL;
+}
+#endif
+
+/* Wake the flusher, wait for it to exit; the next append starts a new one. */
+static void journal_flusher_stop(void) {
+#if !OS_WINDOWS
+    if (!journalFlusherStarted) return;
+    pthread_mutex_lock(&journalLock);
+    journalFlusherStop = 1;
+    pthread_cond_signal(&journalWake);
+    pthread_mutex_unlock(&journalLock);
+    pthread_join(journalFlusher, NULL);
+    journalFlusherStarted = 0;
+    journalFlusherStop = 0;
+#endif
+}
+
+int journal_append(char op, const Student *s, int roll) {
+    journal_lock();
+    if (!journalFp) {
+        journalFp = fopen(JOURNAL_FILE, "a");
+        if (!journalFp) { journal_unlock(); return 0; }
+        journalLastSync = time(NULL);
+    }
+    if (op == 'D') fprintf(journalFp, "D %d\n", roll);
+    else {
+        fprintf(journalFp, "%c ", op);
+        if (storageFormat == STORE_TEXT) write_student_to_file(journalFp, s);
+        else write_student_exact(journalFp, s);
+    }
+    int ok = fflush(journalFp) == 0;
+    if (ok) {
+        journalEntries++;
+        journalPending++;
+        /* without the flusher thread nothing would sync an idle tail, so
+           Windows syncs every entry */
+        if (OS_WINDOWS || commitInterval <= 0 || journalPending >= JOURNAL_GROUP_COMMIT
+            || time(NULL) - journalLastSync >= commitInterval)
+            journal_sync_locked();
+    }
+    journal_unlock();
+#if !OS_WINDOWS
+    if (ok && commitInterval > 0 && !journalFlusherStarted
+        && pthread_create(&journalFlusher, NULL, journal_flusher, NULL) == 0)
+        journalFlusherStarted = 1;
+#endif
+    return ok;
+}
+
+/* Record an edit in the journal and, for the B+tree store, apply it to the
+   cached tree pages in place. */
+int store_update(const Student *s) {
+    if (!journal_append('U', s, 0)) return 0;
+    if (storageFormat == STORE_BTREE && !btree_update(s)) btreeStale = 1;
+    return 1;
+}
+
+int store_delete(int roll) {
+    if (!journal_append('D', NULL, roll)) return 0;
+    if (storageFormat == STORE_BTREE && !btree_delete(roll)) btreeStale = 1;
+    return 1;
+}
+
+int journal_sync(void) {
+    journal_lock();
+    journal_sync_locked();
+    journal_unlock();
+    return 1;
+}
+
+void journal_close(void) {
+    journal_flusher_stop();
+    journal_lock();
+    journal_sync_locked();
+    if (journalFp) fclose(journalFp);
+    journalFp = NULL;
+    journal_unlock();
+}
+
+/* Apply one journal file to the table; returns the length of its complete lines. */
+static long journal_replay_file(const char *path, int *torn) {
+    *torn = 0;
+    FileView v;
+    if (!file_view_open(path, &v)) return 0;
+    const char *p = v.data, *end = v.data + v.size;
+    while (p < end) {
+        const char *nl = memchr(p, '\n', (size_t)(end - p));
+        if (!nl) break;
+        if (nl - p >= 2 && p[1] == ' ') {
+            Student s;
+            if (p[0] == 'D') {
+                table_remove_at(table_find_roll(decode_int(p + 2, nl)));
+            } else if ((p[0] == 'U' || p[0] == 'A') && parse_student_record(p + 2, nl, &s)) {
+                int idx = table_find_roll(s.roll);
+                if (p[0] == 'U' && idx >= 0) table_update_at(idx, &s);
+                else if (p[0] == 'A' && idx < 0) table_insert(&s);
+            }
+            journalEntries++;
+        }
+        p = nl + 1;
+    }
+    long valid = (long)(p - v.data);
+    *torn = p < end;
+    file_view_close(&v);
+    return valid;
+}
+
+/* Apply the journal to the table: first a rotated journal left behind by an
+   unfinished background checkpoint, then the live one. A torn final line (no
+   newline) left by a crash is ignored and cut off so later appends start on a
+   fresh line. */
+int journal_replay(void) {
+    journalEntries = 0;
+    int torn;
+    FILE *old = fopen(JOURNAL_OLD_FILE, "rb");
+    if (old) {
+        fclose(old);
+        journal_replay_file(JOURNAL_OLD_FILE, &torn);
+        checkpointFailed = 1; /* the base may predate it: next checkpoint must be a full one */
+    }
+    long valid = journal_replay_file(JOURNAL_FILE, &torn);
+    if (torn) {
+        journal_close();
+        truncate_file(JOURNAL_FILE, valid);
+    }
+    return 1;
+}
+
+/* Move the live journal aside for a background checkpoint; new edits start a
+   fresh journal. */
+static int journal_rotate(void) {
+    journal_lock();
+    journal_sync_locked();
+    if (journalFp) fclose(journalFp);
+    journalFp = NULL;
+    remove(JOURNAL_OLD_FILE);
+    int ok = rename(JOURNAL_FILE, JOURNAL_OLD_FILE) == 0;
+    if (ok) journalEntries = 0;
+    journal_unlock();
+    return ok;
+}
+
+int journal_reset(void) {
+    store_checkpoint_wait();
+    journal_lock();
+    if (journalFp) fclose(journalFp);
+    journalFp = NULL;
+    journalPending = 0;
+    FILE *fp = fopen(JOURNAL_FILE, "w");
+    int ok = fp && fclose(fp) == 0;
+    if (ok) {
+        journalEntries = 0;
+        remove(JOURNAL_OLD_FILE);
+    }
+    journal_unlock();
+    return ok;
+}
+
+/* Rewrite the base store from the table and empty the journal. The B+tree
+   store already holds every edit in its cached pages, so it only flushes,
+   unless an edit failed to reach the tree. */
+int store_checkpoint(void) {
+    store_checkpoint_wait();
+    table_compact();
+    int flushOnly = storageFormat == STORE_BTREE && !btreeStale;
+    if (flushOnly ? !btree_flush() : !overwrite_students(studentTable, studentCount)) return 0;
+    if (!journal_reset()) return 0;
+    checkpointFailed = 0;
+    btreeStale = 0;
+    return 1;
+}
+
+static void *checkpoint_worker(void *arg) {
+    CheckpointJob *job = arg;
+    job->ok = overwrite_students(job->rows, job->count);
+    if (job->ok) remove(JOURNAL_OLD_FILE);
+    free(job->rows);
+    job->rows = NULL;
+    return NULL;
+}
+
+/* Fold the journal into the base store without blocking the menus: rotate the
+   journal, then write a snapshot of the live rows on a worker thread. If it
+   fails, the rotated journal stays on disk and the next checkpoint is a full
+   synchronous one. */
+int store_checkpoint_async(void) {
+    store_checkpoint_wait();
+    if (checkpointFailed || storageFormat == STORE_BTREE) return store_checkpoint();
+    int n;
+    Student *rows = table_snapshot(&n);
+    if (!rows && n > 0) return store_checkpoint();
+    if (!journal_rotate()) { free(rows); return store_checkpoint(); }
+    checkpointJob.rows = rows;
+    checkpointJob.count = n;
+    checkpointJob.ok = 0;
+    checkpointRunning = 1;
+#if !OS_WINDOWS
+    if (pthread_create(&checkpointThread, NULL, checkpoint_worker, &checkpointJob) == 0) return 1;
+#endif
+    checkpoint_worker(&checkpointJob);
+    checkpointRunning = 0;
+    if (!checkpointJob.ok) checkpointFailed = 1;
+    return checkpointJob.ok;
+}
+
+void store_checkpoint_wait(void) {
+    if (!checkpointRunning) return;
+#if !OS_WINDOWS
+    pthread_join(checkpointThread, NULL);
+#endif
+    checkpointRunning = 0;
+    if (!checkpointJob.ok) checkpointFailed = 1;
+}
+
+int store_maybe_checkpoint(void) {
+    return journalEntries < JOURNAL_CHECKPOINT_ENTRIES || store_checkpoint_async();
+}
+
+/* Make the base store match the table before something reads the file directly. */
+int store_flush(void) {
+    store_checkpoint_wait();
+    if (journalEntries == 0 && !checkpointFailed && !btreeStale) return 1;
+    return store_checkpoint();
 }
 
-/* ---- Student scoring & validation ---- */
-void calculate_student(Student *s) {
-    s->total = 0.0f;
-    for (int i = 0; i < SUBJECTS; ++i) s->total += s->marks[i];
-    s->percentage = (s->total / (100.0f * SUBJECTS)) * 100.0f;
-    if (s->percentage >= 90.0f) strcpy(s->grade, "A+");
-    else if (s->percentage >= 80.0f) strcpy(s->grade, "A");
-    else if (s->percentage >= 70.0f) strcpy(s->grade, "B");
-    else if (s->percentage >= 60.0f) strcpy(s->grade, "C");
-    else if (s->percentage >= 50.0f) strcpy(s->grade, "D");
-    else strcpy(s->grade, "F");
+/* End of session. A short journal is only synced: replaying it on the next
+   load is cheaper than rewriting the whole base store for a few edits. A long
+   one, absolute or relative to the table, is folded in. The B+tree store
+   always flushes, since that writes just the dirty pages and otherwise the
+   next load would rebuild the tree. */
+void store_close(void) {
+    store_checkpoint_wait();
+    if (storageFormat == STORE_BTREE || journalEntries >= JOURNAL_CHECKPOINT_ENTRIES
+        || (long long)journalEntries * 100 >= (long long)table_live_count() * JOURNAL_EXIT_CHECKPOINT_PERCENT)
+        store_flush();
+    journal_close();
 }
 
-int valid_name(const char *name) {
-    return name && name[0] != '\0';
+/* ---- Resident student table ---- */
+/* The table mirrors the student store for the whole session. Reads are served from
+   memory; every mutation writes to disk first and then updates the table. */
+int table_load(void) {
+    table_unload();
+    int n, cap;
+    Student *arr = load_students(&n, &cap);
+    if (arr) {
+        studentDead = calloc((size_t)cap, 1);
+        if (!studentDead) { free(arr); arr = NULL; }
+    }
+    if (arr) {
+        studentTable = arr;
+        studentCount = n;
+        studentCap = cap;
+        size_t bytes = (size_t)cap * (sizeof(Student) + 1);
+        if (bytes > tablePeakBytes) tablePeakBytes = bytes;
+    }
+    table_rebuild_indexes();
+    journal_replay();
+    if (deadCount) table_compact();
+    if (storageFormat == STORE_BTREE && journalEntries > 0) {
+        /* edits the tree never flushed: rebuild it from the replayed table */
+        overwrite_students(studentTable, studentCount);
+        journal_reset();
+    }
+    return arr != NULL;
 }
 
-int valid_marks(float mark) {
-    return (mark >= 0.0f && mark <= 100.0f);
+void table_unload(void) {
+    free(studentTable);
+    free(studentDead);
+    studentTable = NULL;
+    studentDead = NULL;
+    studentCount = studentCap = deadCount = 0;
+    free(rollIndex);
+    rollIndex = NULL;
+    rollIndexCap = rollIndexUsed = 0;
+    name_index_drop();
+    pct_index_drop();
+    rank_tree_drop();
+    grade_bitmaps_drop();
+    cols_free();
+    running_stats_free();
+    btree_close();
 }
 
-/* ---- File helpers ---- */
-/* Line format: roll|name|m1|m2|m3\n */
-int write_student_to_file(FILE *fp, const Student *s) {
-    if (!fp || !s) return 0;
-    fprintf(fp, "%d|%s", s->roll, s->name);
-    for (int i = 0; i < SUBJECTS; ++i) fprintf(fp, "|%.2f", s->marks[i]);
-    fprintf(fp, "\n");
+int table_reserve(int need) {
+    if (need <= studentCap) return 1;
+    int cap = studentCap ? studentCap : 64;
+    while (cap < need) cap *= 2;
+    unsigned char *dead = realloc(studentDead, (size_t)cap);
+    if (!dead) return 0;
+    studentDead = dead;
+    Student *tmp = realloc(studentTable, (size_t)cap * sizeof(Student));
+    if (!tmp) return 0;
+    size_t peak = (size_t)(studentCap + cap) * sizeof(Student) + (size_t)cap;
+    if (peak > tablePeakBytes) tablePeakBytes = peak;
+    studentTable = tmp;
+    studentCap = cap;
     return 1;
 }
 
-int parse_line_to_student(const char *line, Student *s) {
-    if (!line || !s) return 0;
-    char *copy = malloc(strlen(line) + 1);
-    if (!copy) return 0;
-    strcpy(copy, line);
-    size_t len = strlen(copy);
-    if (len && copy[len - 1] == '\n') copy[len - 1] = '\0';
-    char *tok = strtok(copy, "|");
-    if (!tok) { free(copy); return 0; }
-    s->roll = atoi(tok);
-    tok = strtok(NULL, "|");
-    if (!tok) { free(copy); return 0; }
-    strncpy(s->name, tok, MAX_NAME - 1);
-    s->name[MAX_NAME - 1] = '\0';
-    for (int i = 0; i < SUBJECTS; ++i) {
-        tok = strtok(NULL, "|");
-        s->marks[i] = tok ? (float)atof(tok) : 0.0f;
-    }
-    calculate_student(s);
-    free(copy);
+int table_find_roll(int roll) {
+    return roll_index_get(roll);
+}
+
+int table_insert(const Student *s) {
+    if (!table_reserve(studentCount + 1)) return 0;
+    studentTable[studentCount] = *s;
+    studentDead[studentCount] = 0;
+    if (!roll_index_put(s->roll, studentCount)) return 0;
+    studentCount++;
+    cols_append(studentCount - 1);
+    running_stats_add(studentCount - 1);
+    name_index_add(studentCount - 1, NULL);
+    pct_index_add(studentCount - 1);
+    rank_tree_add(s->total, 1);
+    grade_bitmaps_set(studentCount - 1, s->grade, 1);
     return 1;
 }
 
-Student *read_all_students(int *outCount) {
-    *outCount = 0;
-    FILE *fp = fopen(STUDENT_FILE, "r");
-    if (!fp) return NULL;
-    Student *arr = NULL;
-    char line[512];
-    int count = 0;
-    while (fgets(line, sizeof(line), fp)) {
-        Student s;
-        if (parse_line_to_student(line, &s)) {
-            Student *tmp = realloc(arr, (count + 1) * sizeof(Student));
-            if (!tmp) { free(arr); fclose(fp); *outCount = 0; return NULL; }
-            arr = tmp;
-            arr[count++] = s;
-        }
+/* Replace a row in place; its roll is unchanged, so the roll index is too. */
+void table_update_at(int idx, const Student *s) {
+    char oldName[MAX_NAME];
+    memcpy(oldName, studentTable[idx].name, MAX_NAME);
+    float oldPct = studentTable[idx].percentage;
+    float oldTotal = studentTable[idx].total;
+    int oldGrade = studentTable[idx].grade;
+    running_stats_remove(idx);
+    studentTable[idx] = *s;
+    running_stats_add(idx);
+    cols_update(idx);
+    if (strcmp(oldName, s->name) != 0) name_index_add(idx, oldName);
+    if (oldPct != s->percentage) {
+        pct_index_remove(idx, oldPct);
+        pct_index_add(idx);
+    }
+    if (oldTotal != s->total) {
+        rank_tree_add(oldTotal, -1);
+        rank_tree_add(s->total, 1);
+    }
+    if (oldGrade != s->grade) {
+        grade_bitmaps_set(idx, oldGrade, 0);
+        grade_bitmaps_set(idx, s->grade, 1);
     }
-    fclose(fp);
-    *outCount = count;
-    return arr;
 }
 
-int roll_exists(int roll) {
-    FILE *fp = fopen(STUDENT_FILE, "r");
-    if (!fp) return 0;
-    char line[512];
-    while (fgets(line, sizeof(line), fp)) {
-        Student s;
-        if (parse_line_to_student(line, &s)) {
-            if (s.roll == roll) { fclose(fp); return 1; }
-        }
+/* Call after rows move or the table is replaced wholesale. */
+void table_rebuild_indexes(void) {
+    roll_index_rebuild();
+    cols_rebuild();
+    running_stats_rebuild();
+    name_index_drop();
+    pct_index_drop();
+    rank_tree_drop();
+    grade_bitmaps_drop();
+}
+
+/* Tombstone a row: O(1), slots of other rows do not move. */
+void table_remove_at(int idx) {
+    if (idx < 0 || idx >= studentCount || studentDead[idx]) return;
+    roll_index_remove(studentTable[idx].roll);
+    studentDead[idx] = 1;
+    deadCount++;
+    cols_remove(idx);
+    running_stats_remove(idx);
+    name_index_forget();
+    pct_index_remove(idx, studentTable[idx].percentage);
+    rank_tree_add(studentTable[idx].total, -1);
+    grade_bitmaps_set(idx, studentTable[idx].grade, 0);
+}
+
+int table_live_count(void) {
+    return studentCount - deadCount;
+}
+
+/* Squeeze tombstones out in one pass, keeping file order. */
+void table_compact(void) {
+    if (deadCount == 0) return;
+    int w = 0;
+    for (int i = 0; i < studentCount; ++i) {
+        if (studentDead[i]) continue;
+        if (w != i) studentTable[w] = studentTable[i];
+        studentDead[w++] = 0;
     }
-    fclose(fp);
-    return 0;
+    studentCount = w;
+    deadCount = 0;
+    table_rebuild_indexes();
 }
 
-int append_student(const Student *s) {
-    FILE *fp = fopen(STUDENT_FILE, "a");
-    if (!fp) return 0;
-    int ok = write_student_to_file(fp, s);
-    fclose(fp);
-    return ok;
+void table_maybe_compact(void) {
+    if (deadCount >= COMPACT_MIN_DEAD && deadCount * 100 >= studentCount * COMPACT_DEAD_PERCENT) table_compact();
 }
 
-int overwrite_students(Student *arr, int count) {
-    FILE *fp = fopen(STUDENT_FILE, "w");
-    if (!fp) return 0;
-    for (int i = 0; i < count; ++i) write_student_to_file(fp, &arr[i]);
-    fclose(fp);
-    return 1;
+/* Copy of the live rows in table order (caller frees). */
+Student *table_snapshot(int *outCount) {
+    int n = table_live_count();
+    *outCount = n;
+    Student *rows = malloc((size_t)(n ? n : 1) * sizeof(Student));
+    if (!rows) return NULL;
+    int w = 0;
+    for (int i = 0; i < studentCount; ++i) if (!studentDead[i]) rows[w++] = studentTable[i];
+    return rows;
 }
 
 /* ---- Credentials helpers ---- */
@@ -421,8 +3755,10 @@ void feature_add_student(void) {
     }
     clear_input_line();
     calculate_student(&s);
-    if (append_student(&s)) printf("Student added successfully!\n");
-    else printf("Error: could not append to file.\n");
+    if (!append_student(&s)) { printf("Error: could not append to file.\n"); return; }
+    if (!table_insert(&s)) table_load();
+    store_maybe_checkpoint();
+    printf("Student added successfully!\n");
 }
 
 void print_students_header(void) {
@@ -432,81 +3768,167 @@ void print_students_header(void) {
     printf("-------------------------------------------------------------------------------\n");
 }
 
+void print_student_row(const Student *s) {
+    printf("%-6d %-20s", s->roll, s->name);
+    for (int j = 0; j < SUBJECTS; ++j) printf(" %-8.2f", s->marks[j]);
+    printf(" %-8.2f %-10.2f %-6s\n", s->total, s->percentage, gradeNames[s->grade]);
+}
+
 int display_students_table(Student *arr, int count) {
     if (count == 0) { printf("No student records.\n"); return 0; }
     print_students_header();
-    for (int i = 0; i < count; ++i) {
-        printf("%-6d %-20s", arr[i].roll, arr[i].name);
-        for (int j = 0; j < SUBJECTS; ++j) printf(" %-8.2f", arr[i].marks[j]);
-        printf(" %-8.2f %-10.2f %-6s\n", arr[i].total, arr[i].percentage, arr[i].grade);
-    }
+    for (int i = 0; i < count; ++i) print_student_row(&arr[i]);
     return 1;
 }
 
 void feature_display_all(void) {
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr) { printf("No records to display.\n"); return; }
-    display_students_table(arr, n);
-    free(arr);
+    if (table_live_count() == 0) { printf("No records to display.\n"); return; }
+    print_students_header();
+    for (int i = 0; i < studentCount; ++i) if (!studentDead[i]) print_student_row(&studentTable[i]);
+}
+
+/* btree_scan callback for the roll range search */
+static void print_scanned_row(const Student *s, void *found) {
+    if (!*(int *)found) print_students_header();
+    print_student_row(s);
+    *(int *)found = 1;
 }
 
 void feature_search(void) {
-    printf("\nSearch by:\n1) Name (partial)\n2) Roll No\n3) Marks Range\n4) Grade\nEnter choice: ");
+    printf("\nSearch by:\n1) Name (partial)\n2) Roll No\n3) Marks Range\n4) Grade\n5) Roll Range\n6) Top Percent of Class\n7) Combined Filter\nEnter choice: ");
     int ch;
     if (scanf("%d", &ch) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
     clear_input_line();
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr || n == 0) { printf("No records.\n"); free(arr); return; }
+    int n = studentCount;
+    Student *arr = studentTable;
+    if (table_live_count() == 0) { printf("No records.\n"); return; }
     int found = 0;
     if (ch == 1) {
         char q[128];
         printf("Enter name or partial: ");
         safe_gets(q, sizeof(q));
-        for (int i = 0; i < n; ++i) {
-            if (contains_case_insensitive(arr[i].name, q)) {
+        int *hits;
+        int m = name_index_search(q, &hits);
+        if (m >= 0) {
+            for (int i = 0; i < m; ++i) {
                 if (!found) print_students_header();
-                printf("%-6d %-20s", arr[i].roll, arr[i].name);
-                for (int j = 0; j < SUBJECTS; ++j) printf(" %-8.2f", arr[i].marks[j]);
-                printf(" %-8.2f %-10.2f %-6s\n", arr[i].total, arr[i].percentage, arr[i].grade);
+                print_student_row(&arr[hits[i]]);
                 found = 1;
             }
+            free(hits);
+        } else {
+            for (int i = 0; i < n; ++i) {
+                if (!studentDead[i] && contains_case_insensitive(arr[i].name, q)) {
+                    if (!found) print_students_header();
+                    print_student_row(&arr[i]);
+                    found = 1;
+                }
+            }
         }
     } else if (ch == 2) {
         int r;
         printf("Enter roll: ");
-        if (scanf("%d", &r) != 1) { clear_input_line(); printf("Invalid.\n"); free(arr); return; }
+        if (scanf("%d", &r) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
         clear_input_line();
-        for (int i = 0; i < n; ++i) if (arr[i].roll == r) { display_students_table(&arr[i], 1); found = 1; break; }
+        int idx = table_find_roll(r);
+        if (idx >= 0) { display_students_table(&arr[idx], 1); print_class_rank(idx); found = 1; }
     } else if (ch == 3) {
         float lo, hi;
         printf("Enter lower bound of percentage: ");
-        if (scanf("%f", &lo) != 1) { clear_input_line(); printf("Invalid.\n"); free(arr); return; }
+        if (scanf("%f", &lo) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
         printf("Enter upper bound of percentage: ");
-        if (scanf("%f", &hi) != 1) { clear_input_line(); printf("Invalid.\n"); free(arr); return; }
+        if (scanf("%f", &hi) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
         clear_input_line();
-        for (int i = 0; i < n; ++i) if (arr[i].percentage >= lo && arr[i].percentage <= hi) {
-            if (!found) print_students_header();
-            printf("%-6d %-20s %-8.2f\n", arr[i].roll, arr[i].name, arr[i].percentage);
-            found = 1;
+        int first, m = pct_index_range(lo, hi, &first);
+        if (m >= 0) {
+            /* lowest percentage first */
+            for (int k = first; k < first + m; ++k) {
+                const Student *st = &arr[pctIndex[k].idx];
+                if (!found) print_students_header();
+                printf("%-6d %-20s %-8.2f\n", st->roll, st->name, st->percentage);
+                found = 1;
+            }
+        } else {
+            for (int i = 0; i < n; ++i) if (!studentDead[i] && arr[i].percentage >= lo && arr[i].percentage <= hi) {
+                if (!found) print_students_header();
+                printf("%-6d %-20s %-8.2f\n", arr[i].roll, arr[i].name, arr[i].percentage);
+                found = 1;
+            }
         }
     } else if (ch == 4) {
         char gradeQuery[8];
         printf("Enter grade to search (A+, A, B, C, D, F): ");
         safe_gets(gradeQuery, sizeof(gradeQuery));
-        for (int i = 0; i < n; ++i) {
-            if (portable_strcasecmp(arr[i].grade, gradeQuery) == 0) {
+        int g = grade_from_label(gradeQuery);
+        if (g >= 0) {
+            if (!gradeBitmapsBuilt && !grade_bitmaps_rebuild()) { printf("Memory error.\n"); return; }
+            int *slots, m = bm_slots(&gradeBitmaps[g], &slots);
+            if (m < 0) { printf("Memory error.\n"); return; }
+            for (int k = 0; k < m; ++k) {
+                const Student *st = &arr[slots[k]];
                 if (!found) print_students_header();
-                printf("%-6d %-20s %-6s %-8.2f\n", arr[i].roll, arr[i].name, arr[i].grade, arr[i].percentage);
+                printf("%-6d %-20s %-6s %-8.2f\n", st->roll, st->name, gradeNames[st->grade], st->percentage);
                 found = 1;
             }
+            free(slots);
         }
+    } else if (ch == 5) {
+        int lo, hi;
+        printf("Enter lowest roll: ");
+        if (scanf("%d", &lo) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
+        printf("Enter highest roll: ");
+        if (scanf("%d", &hi) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
+        clear_input_line();
+        /* the B+tree walks its leaves in roll order; other stores sort the matches */
+        if (storageFormat == STORE_BTREE && btree_scan(lo, hi, print_scanned_row, &found) >= 0) {
+            /* printed by the scan */
+        } else {
+            found = 0;
+            Student *hits = malloc(sizeof(Student) * (size_t)(n > 0 ? n : 1));
+            if (!hits) { printf("Memory error.\n"); return; }
+            int m = 0;
+            for (int i = 0; i < n; ++i)
+                if (!studentDead[i] && arr[i].roll >= lo && arr[i].roll <= hi) hits[m++] = arr[i];
+            qsort(hits, m, sizeof(Student), cmp_roll_asc);
+            for (int i = 0; i < m; ++i) print_scanned_row(&hits[i], &found);
+            free(hits);
+        }
+    } else if (ch == 6) {
+        float top;
+        printf("Show top what percent of the class (e.g. 10): ");
+        if (scanf("%f", &top) != 1 || !(top > 0.0f && top <= 100.0f)) { clear_input_line(); printf("Invalid.\n"); return; }
+        clear_input_line();
+        if (!pctIndexBuilt && !pct_index_rebuild()) { printf("Memory error.\n"); return; }
+        /* the tail of the percentage index, best first */
+        double want = (double)pctIndexCount * top / 100.0;
+        int take = (int)want;
+        if (take < want) take++;
+        for (int k = pctIndexCount - 1; k >= pctIndexCount - take; --k) {
+            const Student *st = &arr[pctIndex[k].idx];
+            if (!found) print_students_header();
+            printf("%-6d %-20s %-8.2f\n", st->roll, st->name, st->percentage);
+            found = 1;
+        }
+    } else if (ch == 7) {
+        char expr[256];
+        printf("Terms: grade=B, name=ra (quote values with spaces), pct=60-75\n");
+        printf("Join with and/or, e.g. grade=B and name=ra or pct=90-100\nFilter: ");
+        safe_gets(expr, sizeof(expr));
+        Bitmap result = {0};
+        if (!filter_eval(expr, &result)) { printf("Invalid filter.\n"); return; }
+        int *slots, m = bm_slots(&result, &slots);
+        bm_free(&result);
+        if (m < 0) { printf("Memory error.\n"); return; }
+        for (int k = 0; k < m; ++k) {
+            if (!found) print_students_header();
+            print_student_row(&arr[slots[k]]);
+            found = 1;
+        }
+        free(slots);
     } else {
         printf("Invalid option.\n");
     }
     if (!found) printf("No matching records found.\n");
-    free(arr);
 }
 
 void feature_update_student(void) {
@@ -517,30 +3939,25 @@ void feature_update_student(void) {
     printf("Enter roll to update: ");
     if (scanf("%d", &roll) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
     clear_input_line();
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr) { printf("No records.\n"); return; }
-    int found = 0;
-    for (int i = 0; i < n; ++i) {
-        if (arr[i].roll == roll) {
-            found = 1;
-            printf("Current name: %s\nNew name (blank to keep): ", arr[i].name);
-            char tmp[MAX_NAME]; safe_gets(tmp, sizeof(tmp));
-            if (strlen(tmp) > 0) strncpy(arr[i].name, tmp, MAX_NAME - 1);
-            for (int j = 0; j < SUBJECTS; ++j) {
-                printf("Current %s: %.2f\nNew %s (-1 to keep): ", subjectNames[j], arr[i].marks[j], subjectNames[j]);
-                float m;
-                if (scanf("%f", &m) != 1) { clear_input_line(); printf("Invalid input. Skipping.\n"); continue; }
-                if (m >= 0.0f && m <= 100.0f) arr[i].marks[j] = m;
-            }
-            clear_input_line();
-            calculate_student(&arr[i]);
-            break;
-        }
+    if (table_live_count() == 0) { printf("No records.\n"); return; }
+    int idx = table_find_roll(roll);
+    if (idx < 0) { printf("Roll not found.\n"); return; }
+    Student s = studentTable[idx];
+    printf("Current name: %s\nNew name (blank to keep): ", s.name);
+    char tmp[MAX_NAME]; safe_gets(tmp, sizeof(tmp));
+    if (strlen(tmp) > 0) strncpy(s.name, tmp, MAX_NAME - 1);
+    for (int j = 0; j < SUBJECTS; ++j) {
+        printf("Current %s: %.2f\nNew %s (-1 to keep): ", subjectNames[j], s.marks[j], subjectNames[j]);
+        float m;
+        if (scanf("%f", &m) != 1) { clear_input_line(); printf("Invalid input. Skipping.\n"); continue; }
+        if (m >= 0.0f && m <= 100.0f) s.marks[j] = m;
     }
-    if (!found) { printf("Roll not found.\n"); free(arr); return; }
-    if (!overwrite_students(arr, n)) printf("Error saving updates.\n"); else printf("Record updated.\n");
-    free(arr);
+    clear_input_line();
+    calculate_student(&s);
+    if (!store_update(&s)) { printf("Error saving updates.\n"); return; }
+    table_update_at(idx, &s);
+    store_maybe_checkpoint();
+    printf("Record updated.\n");
 }
 
 void feature_delete_student(void) {
@@ -549,30 +3966,32 @@ void feature_delete_student(void) {
     printf("Enter roll to delete: ");
     if (scanf("%d", &roll) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
     clear_input_line();
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr) { printf("No records.\n"); return; }
-    int idx = -1;
-    for (int i = 0; i < n; ++i) if (arr[i].roll == roll) { idx = i; break; }
-    if (idx == -1) { printf("Roll not found.\n"); free(arr); return; }
-    for (int i = idx; i < n - 1; ++i) arr[i] = arr[i + 1];
-    n--;
-    if (!overwrite_students(arr, n)) printf("Error deleting.\n"); else printf("Deleted successfully.\n");
-    free(arr);
+    if (table_live_count() == 0) { printf("No records.\n"); return; }
+    int idx = table_find_roll(roll);
+    if (idx == -1) { printf("Roll not found.\n"); return; }
+    if (!store_delete(roll)) { printf("Error deleting.\n"); return; }
+    table_remove_at(idx);
+    table_maybe_compact();
+    store_maybe_checkpoint();
+    printf("Deleted successfully.\n");
 }
 
 void feature_delete_all(void) {
     if (strcmp(currentRole, "ADMIN") != 0) { printf("Only ADMIN can delete all records.\n"); return; }
     if (!yesno("Are you sure you want to DELETE ALL STUDENT RECORDS?")) { printf("Operation cancelled.\n"); return; }
-    FILE *fp = fopen(STUDENT_FILE, "w");
-    if (!fp) { printf("Error clearing file.\n"); return; }
-    fclose(fp);
+    store_checkpoint_wait();
+    if (!overwrite_students(NULL, 0) || !journal_reset()) { printf("Error clearing file.\n"); return; }
+    studentCount = deadCount = 0;
+    table_rebuild_indexes();
     printf("All records deleted.\n");
 }
 
-/* Sorting helpers */
-int cmp_roll_asc(const void *a, const void *b) { return ((Student*)a)->roll - ((Student*)b)->roll; }
-int cmp_roll_desc(const void *a, const void *b) { return ((Student*)b)->roll - ((Student*)a)->roll; }
+/* Sorting helpers (compare, never subtract: roll differences can overflow) */
+int cmp_roll_asc(const void *a, const void *b) {
+    int x = ((const Student*)a)->roll, y = ((const Student*)b)->roll;
+    return (x > y) - (x < y);
+}
+int cmp_roll_desc(const void *a, const void *b) { return cmp_roll_asc(b, a); }
 int cmp_name(const void *a, const void *b) { return portable_strcasecmp(((Student*)a)->name, ((Student*)b)->name); }
 int cmp_marks_desc(const void *a, const void *b) {
     float diff = ((Student*)b)->total - ((Student*)a)->total;
@@ -581,95 +4000,725 @@ int cmp_marks_desc(const void *a, const void *b) {
     return 0;
 }
 
+/* Unsigned keys that order like the value: flip the sign bit of an int; for
+   an IEEE float flip every bit of a negative and only the sign of the rest. */
+unsigned radix_key_int(int v) {
+    return (unsigned)v ^ 0x80000000u;
+}
+
+unsigned radix_key_float(float v) {
+    unsigned bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+}
+
+/* Stable LSD radix sort of perm[0..n) by keys[0..n) (keys[k] belongs to
+   perm[k]; both arrays are reordered). Three passes of 11, 11 and 10 bits;
+   a pass whose digit is the same for every key is skipped. */
+int radix_sort_perm(unsigned *keys, int *perm, int n) {
+    unsigned *tmpKeys = malloc((size_t)(n ? n : 1) * sizeof(unsigned));
+    int *tmpPerm = malloc((size_t)(n ? n : 1) * sizeof(int));
+    if (!tmpKeys || !tmpPerm) { free(tmpKeys); free(tmpPerm); return 0; }
+    static const int shifts[3] = {0, 11, 22};
+    unsigned *srcK = keys, *dstK = tmpKeys;
+    int *srcP = perm, *dstP = tmpPerm;
+    for (int pass = 0; pass < 3; ++pass) {
+        int shift = shifts[pass];
+        unsigned mask = pass == 2 ? 0x3ffu : 0x7ffu;
+        int count[2048];
+        memset(count, 0, sizeof(count));
+        for (int k = 0; k < n; ++k) count[(srcK[k] >> shift) & mask]++;
+        if (n == 0 || count[(srcK[0] >> shift) & mask] == n) continue;
+        int sum = 0;
+        for (int d = 0; d <= (int)mask; ++d) { int c = count[d]; count[d] = sum; sum += c; }
+        for (int k = 0; k < n; ++k) {
+            int at = count[(srcK[k] >> shift) & mask]++;
+            dstK[at] = srcK[k];
+            dstP[at] = srcP[k];
+        }
+        unsigned *tk = srcK; srcK = dstK; dstK = tk;
+        int *tp = srcP; srcP = dstP; dstP = tp;
+    }
+    if (srcP != perm) {
+        memcpy(perm, srcP, (size_t)n * sizeof(int));
+        memcpy(keys, srcK, (size_t)n * sizeof(unsigned));
+    }
+    free(tmpKeys);
+    free(tmpPerm);
+    return 1;
+}
+
+/* ---- Multi-key sort ---- */
+/* Stable sort of column positions by several columns at once, e.g.
+   "grade asc, total desc, name asc". Every key is converted once before the
+   sort into something cheap to compare: numeric columns into radix order keys
+   (complemented for desc), names into a case-folded copy plus its first eight
+   bytes as a big-endian integer, so no comparison calls tolower() and most
+   name comparisons never reach strcmp(). The leading keys are then packed
+   into a 16-byte record key next to the row's position, so the sort itself
+   streams through one array and only looks up the per-column keys when two
+   packed keys tie. A single numeric key goes to the radix sort; anything
+   else is a merge sort, one run per worker thread, merged pairwise in
+   parallel. */
+#define SORT_INSERTION_RUN 32
+
+static const char *const sortFieldNames[SORT_FIELD_COUNT] = {"roll", "name", "total", "pct", "grade"};
+
+/* Parse "field [asc|desc], ..."; fields are roll, name, total, pct and grade
+   (grade asc is A+ first). Returns 0 on a malformed spec. */
+int sort_plan_parse(const char *spec, SortPlan *plan) {
+    memset(plan, 0, sizeof(*plan));
+    const char *p = spec;
+    for (;;) {
+        char field[16], dir[8];
+        int n = 0;
+        while (*p == ' ' || *p == '\t') p++;
+        while (*p && *p != ',' && *p != ' ' && *p != '\t' && n < (int)sizeof(field) - 1) field[n++] = *p++;
+        field[n] = '\0';
+        while (*p == ' ' || *p == '\t') p++;
+        n = 0;
+        while (*p && *p != ',' && *p != ' ' && *p != '\t' && n < (int)sizeof(dir) - 1) dir[n++] = *p++;
+        dir[n] = '\0';
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p && *p != ',') return 0;
+        int f = -1;
+        for (int i = 0; i < SORT_FIELD_COUNT; ++i)
+            if (portable_strcasecmp(field, sortFieldNames[i]) == 0) f = i;
+        if (f < 0 || plan->nkeys == MAX_SORT_KEYS) return 0;
+        int desc = portable_strcasecmp(dir, "desc") == 0;
+        if (!desc && dir[0] && portable_strcasecmp(dir, "asc") != 0) return 0;
+        plan->field[plan->nkeys] = f;
+        plan->desc[plan->nkeys] = desc;
+        plan->nkeys++;
+        if (!*p) return 1;
+        p++;
+    }
+}
+
+/* Build the per-position keys from the column store (which must be ready). */
+int sort_plan_prepare(SortPlan *plan) {
+    int n = cols.count, m = n ? n : 1, needName = 0;
+    for (int k = 0; k < plan->nkeys; ++k) {
+        if (plan->field[k] == SORT_NAME) { needName = 1; continue; }
+        unsigned *key = plan->num[k] = malloc((size_t)m * sizeof(unsigned));
+        if (!key) return 0;
+        unsigned flip = plan->desc[k] ? ~0u : 0u;
+        for (int pos = 0; pos < n; ++pos) {
+            unsigned v;
+            switch (plan->field[k]) {
+            case SORT_ROLL: v = radix_key_int(cols.roll[pos]); break;
+            case SORT_TOTAL: v = radix_key_float(cols.total[pos]); break;
+            case SORT_PCT: v = radix_key_float(cols.pct[pos]); break;
+            default: v = cols.grade[pos]; break;
+            }
+            key[pos] = v ^ flip;
+        }
+    }
+    /* grade packs into one byte, other numbers into four, a name into its
+       eight-byte prefix; ties on the packed key are exact only if nothing
+       was cut off */
+    int bytes = 0;
+    for (int k = 0; k < plan->nkeys; ++k)
+        bytes += plan->field[k] == SORT_NAME ? 17 : plan->field[k] == SORT_GRADE ? 1 : 4;
+    plan->exact = bytes <= 16;
+    if (!needName) return 1;
+    size_t heapSize = 0;
+    for (int pos = 0; pos < n; ++pos) heapSize += strlen(col_name(pos)) + 1;
+    plan->namePrefix = malloc((size_t)m * sizeof(unsigned long long));
+    plan->nameOff = malloc((size_t)m * sizeof(unsigned));
+    plan->nameHeap = malloc(heapSize ? heapSize : 1);
+    if (!plan->namePrefix || !plan->nameOff || !plan->nameHeap) return 0;
+    size_t at = 0;
+    for (int pos = 0; pos < n; ++pos) {
+        const unsigned char *src = (const unsigned char *)col_name(pos);
+        char *dst = plan->nameHeap + at;
+        unsigned long long prefix = 0;
+        int len = 0;
+        for (; src[len]; ++len) {
+            dst[len] = (char)tolower(src[len]);
+            if (len < 8) prefix |= (unsigned long long)(unsigned char)dst[len] << (56 - 8 * len);
+        }
+        dst[len] = '\0';
+        plan->namePrefix[pos] = prefix;
+        plan->nameOff[pos] = (unsigned)at;
+        at += (size_t)len + 1;
+    }
+    return 1;
+}
+
+void sort_plan_free(SortPlan *plan) {
+    for (int k = 0; k < plan->nkeys; ++k) { free(plan->num[k]); plan->num[k] = NULL; }
+    free(plan->namePrefix);
+    free(plan->nameOff);
+    free(plan->nameHeap);
+    plan->namePrefix = NULL;
+    plan->nameOff = NULL;
+    plan->nameHeap = NULL;
+}
+
+/* Compare two column positions key by key. Folded names order like
+   portable_strcasecmp(); equal prefixes with a zero last byte mean the names
+   ended inside the prefix and are equal. */
+static int sort_plan_cmp(const SortPlan *p, int a, int b) {
+    for (int k = 0; k < p->nkeys; ++k) {
+        int c;
+        if (p->num[k]) {
+            unsigned x = p->num[k][a], y = p->num[k][b];
+            c = (x > y) - (x < y);
+        } else {
+            unsigned long long x = p->namePrefix[a], y = p->namePrefix[b];
+            if (x != y) c = x < y ? -1 : 1;
+            else if ((x & 0xff) == 0) c = 0;
+            else c = strcmp(p->nameHeap + p->nameOff[a] + 8, p->nameHeap + p->nameOff[b] + 8);
+            if (p->desc[k]) c = -c;
+        }
+        if (c) return c;
+    }
+    return 0;
+}
+
+static int sort_rec_cmp(const SortPlan *p, const SortRec *a, const SortRec *b) {
+    if (a->key[0] != b->key[0]) return a->key[0] < b->key[0] ? -1 : 1;
+    if (a->key[1] != b->key[1]) return a->key[1] < b->key[1] ? -1 : 1;
+    return p->exact ? 0 : sort_plan_cmp(p, a->pos, b->pos);
+}
+
+/* Pack the leading keys of one position, most significant byte first; the
+   first name key ends the packing. */
+static void sort_rec_fill(const SortPlan *p, int pos, SortRec *r) {
+    unsigned long long w[2] = {0, 0};
+    int bit = 128;                /* bits still free */
+    for (int k = 0; k < p->nkeys && bit > 0; ++k) {
+        unsigned long long v;
+        int width;
+        if (p->field[k] == SORT_NAME) {
+            v = p->desc[k] ? ~p->namePrefix[pos] : p->namePrefix[pos];
+            width = 64;
+        } else {
+            v = p->num[k][pos];
+            width = p->field[k] == SORT_GRADE ? 8 : 32;
+            if (p->field[k] == SORT_GRADE) v &= 0xff;
+        }
+        if (width > bit) { v >>= width - bit; width = bit; }
+        bit -= width;
+        /* place v at bits [bit, bit + width) of the 128-bit key */
+        if (bit >= 64) w[0] |= v << (bit - 64);
+        else if (bit + width <= 64) w[1] |= v << bit;
+        else { w[0] |= v >> (64 - bit); w[1] |= v << bit; }
+        if (p->field[k] == SORT_NAME) break;
+    }
+    r->key[0] = w[0];
+    r->key[1] = w[1];
+    r->pos = pos;
+}
+
+/* Merge src[lo..mid) and src[mid..hi) into dst[lo..hi), left run first on ties. */
+static void merge_runs(const SortPlan *p, const SortRec *src, SortRec *dst, int lo, int mid, int hi) {
+    int i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) dst[k++] = sort_rec_cmp(p, &src[j], &src[i]) < 0 ? src[j++] : src[i++];
+    while (i < mid) dst[k++] = src[i++];
+    while (j < hi) dst[k++] = src[j++];
+}
+
+/* Stable sort of a[lo..hi) using tmp[lo..hi) as scratch: insertion-sorted
+   blocks, then bottom-up merges. */
+static void sort_run(const SortPlan *p, SortRec *a, SortRec *tmp, int lo, int hi) {
+    for (int b = lo; b < hi; b += SORT_INSERTION_RUN) {
+        int e = hi - b > SORT_INSERTION_RUN ? b + SORT_INSERTION_RUN : hi;
+        for (int i = b + 1; i < e; ++i) {
+            SortRec v = a[i];
+            int j = i;
+            while (j > b && sort_rec_cmp(p, &v, &a[j - 1]) < 0) { a[j] = a[j - 1]; j--; }
+            a[j] = v;
+        }
+    }
+    SortRec *src = a, *dst = tmp;
+    for (int w = SORT_INSERTION_RUN; w < hi - lo; w *= 2) {
+        for (int b = lo; b < hi; b += 2 * w) {
+            int mid = hi - b > w ? b + w : hi;
+            int e = hi - mid > w ? mid + w : hi;
+            merge_runs(p, src, dst, b, mid, e);
+        }
+        SortRec *t = src; src = dst; dst = t;
+    }
+    if (src != a) memcpy(a + lo, src + lo, (size_t)(hi - lo) * sizeof(SortRec));
+}
+
+typedef struct {
+    const SortPlan *plan;
+    SortRec *src, *dst;
+    const int *perm;
+    int lo, mid, hi;
+} SortJob;
+
+static void *sort_run_worker(void *arg) {
+    SortJob *job = arg;
+    for (int k = job->lo; k < job->hi; ++k) sort_rec_fill(job->plan, job->perm[k], &job->src[k]);
+    sort_run(job->plan, job->src, job->dst, job->lo, job->hi);
+    return NULL;
+}
+
+static void *merge_worker(void *arg) {
+    SortJob *job = arg;
+    merge_runs(job->plan, job->src, job->dst, job->lo, job->mid, job->hi);
+    return NULL;
+}
+
+/* Stable sort of perm[0..n) (column positions) by the prepared plan. */
+int multi_sort(const SortPlan *plan, int *perm, int n) {
+    if (plan->nkeys == 1 && plan->num[0]) {
+        unsigned *keys = malloc((size_t)(n ? n : 1) * sizeof(unsigned));
+        if (!keys) return 0;
+        for (int k = 0; k < n; ++k) keys[k] = plan->num[0][perm[k]];
+        int ok = radix_sort_perm(keys, perm, n);
+        free(keys);
+        return ok;
+    }
+    SortRec *recs = malloc((size_t)(n ? n : 1) * sizeof(SortRec));
+    SortRec *tmp = malloc((size_t)(n ? n : 1) * sizeof(SortRec));
+    if (!recs || !tmp) { free(recs); free(tmp); return 0; }
+    int runs = n >= PARALLEL_SORT_MIN_ROWS ? worker_threads() : 1;
+    int bounds[MAX_WORKERS + 1];
+    SortJob jobs[MAX_WORKERS];
+    for (int t = 0; t <= runs; ++t) bounds[t] = (int)((long long)n * t / runs);
+    for (int t = 0; t < runs; ++t)
+        jobs[t] = (SortJob){plan, recs, tmp, perm, bounds[t], bounds[t + 1], bounds[t + 1]};
+    run_workers(sort_run_worker, jobs, sizeof(SortJob), runs);
+    /* merge neighbouring runs pairwise, one merge per thread, until one is left */
+    SortRec *src = recs, *dst = tmp;
+    while (runs > 1) {
+        int pairs = 0;
+        for (int r = 0; r < runs; r += 2) {
+            int mid = bounds[r + 1], hi = r + 2 <= runs ? bounds[r + 2] : mid;
+            jobs[pairs] = (SortJob){plan, src, dst, perm, bounds[r], mid, hi};
+            bounds[pairs++] = bounds[r];
+        }
+        bounds[pairs] = n;
+        run_workers(merge_worker, jobs, sizeof(SortJob), pairs);
+        runs = pairs;
+        SortRec *t = src; src = dst; dst = t;
+    }
+    for (int k = 0; k < n; ++k) perm[k] = src[k].pos;
+    free(recs);
+    free(tmp);
+    return 1;
+}
+
 void feature_sorting(void) {
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr || n == 0) { printf("No records to sort.\n"); free(arr); return; }
-    printf("Sort by:\n1) Roll Asc\n2) Roll Desc\n3) Name\n4) Total Marks Desc\nEnter choice: ");
+    int n = table_live_count();
+    if (n == 0) { printf("No records to sort.\n"); return; }
+    printf("Sort by:\n1) Roll Asc\n2) Roll Desc\n3) Name\n4) Total Marks Desc\n5) Several Columns\nEnter choice: ");
     int ch;
-    if (scanf("%d", &ch) != 1) { clear_input_line(); printf("Invalid.\n"); free(arr); return; }
+    if (scanf("%d", &ch) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
     clear_input_line();
-    if (ch == 1) qsort(arr, n, sizeof(Student), cmp_roll_asc);
-    else if (ch == 2) qsort(arr, n, sizeof(Student), cmp_roll_desc);
-    else if (ch == 3) qsort(arr, n, sizeof(Student), cmp_name);
-    else if (ch == 4) qsort(arr, n, sizeof(Student), cmp_marks_desc);
-    else { printf("Invalid choice.\n"); free(arr); return; }
+    static const char *const presets[] = {"roll asc", "roll desc", "name asc", "total desc"};
+    char spec[256];
+    if (ch >= 1 && ch <= 4) {
+        snprintf(spec, sizeof(spec), "%s", presets[ch - 1]);
+    } else if (ch == 5) {
+        printf("Columns: roll, name, total, pct, grade; each asc (default) or desc\n");
+        printf("e.g. grade asc, total desc, name asc\nSort by: ");
+        safe_gets(spec, sizeof(spec));
+    } else {
+        printf("Invalid choice.\n");
+        return;
+    }
+    SortPlan plan;
+    if (!sort_plan_parse(spec, &plan)) { printf("Invalid sort columns.\n"); return; }
+    /* sort column positions by the precomputed keys, then gather the rows in
+       that order; the resident table keeps file order */
+    if (!cols_ready()) { printf("Out of memory.\n"); return; }
+    n = cols.count;
+    int *perm = malloc((size_t)(n ? n : 1) * sizeof(int));
+    Student *arr = malloc((size_t)(n ? n : 1) * sizeof(Student));
+    int ok = perm && arr && sort_plan_prepare(&plan);
+    if (ok) {
+        /* start from file order so rows equal on every key keep it */
+        int w = 0;
+        for (int i = 0; i < studentCount; ++i) if (!studentDead[i]) perm[w++] = cols.colPos[i];
+        ok = multi_sort(&plan, perm, n);
+    }
+    sort_plan_free(&plan);
+    if (!ok) { free(perm); free(arr); printf("Out of memory.\n"); return; }
+    for (int k = 0; k < n; ++k) arr[k] = studentTable[cols.slot[perm[k]]];
+    free(perm);
     display_students_table(arr, n);
     if (yesno("Save sorted order to file?")) {
-        if (overwrite_students(arr, n)) printf("Saved.\n"); else printf("Error saving.\n");
+        table_compact();
+        memcpy(studentTable, arr, (size_t)n * sizeof(Student));
+        table_rebuild_indexes();
+        if (store_checkpoint()) printf("Saved.\n"); else printf("Error saving.\n");
     }
     free(arr);
 }
 
-void feature_statistics(void) {
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr || n == 0) { printf("No records.\n"); free(arr); return; }
-    float maxPerc = -1.0f, minPerc = 101.0f, sum = 0.0f;
-    int pass = 0;
-    int maxIdx = 0, minIdx = 0;
-    for (int i = 0; i < n; ++i) {
-        sum += arr[i].percentage;
-        if (arr[i].percentage > maxPerc) { maxPerc = arr[i].percentage; maxIdx = i; }
-        if (arr[i].percentage < minPerc) { minPerc = arr[i].percentage; minIdx = i; }
-        if (arr[i].percentage >= 50.0f) pass++;
+/* ---- Ranking ---- */
+/* Top or bottom K rows by total or by one subject, without sorting the
+   class: one pass over the column keeps the K best rows seen so far in a
+   heap whose root is the weakest of them, so a row costs one comparison
+   unless it displaces the root (O(n log K)). Equal values rank the earlier
+   table slot first, like a stable sort of the table would. */
+static int rank_better(const RankEntry *a, const RankEntry *b, int bottom) {
+    if (a->value != b->value) return bottom ? a->value < b->value : a->value > b->value;
+    return a->slot < b->slot;
+}
+
+static void rank_sift_down(RankEntry *heap, int n, int i, int bottom) {
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= n) return;
+        if (c + 1 < n && rank_better(&heap[c], &heap[c + 1], bottom)) c++;
+        if (!rank_better(&heap[i], &heap[c], bottom)) return;
+        RankEntry t = heap[i]; heap[i] = heap[c]; heap[c] = t;
+        i = c;
+    }
+}
+
+/* Best k rows first into out (room for k); subject -1 ranks by total.
+   Returns the number of rows written, or -1 if the columns are unavailable. */
+int rank_top_k(int subject, int bottom, int k, RankEntry *out) {
+    if (!cols_ready()) return -1;
+    const float *col = subject < 0 ? cols.total : cols.marks[subject];
+    int n = 0;
+    for (int pos = 0; pos < cols.count; ++pos) {
+        RankEntry e = {col[pos], cols.slot[pos]};
+        if (n < k) {
+            /* sift up */
+            int i = n++;
+            while (i > 0 && rank_better(&out[(i - 1) / 2], &e, bottom)) { out[i] = out[(i - 1) / 2]; i = (i - 1) / 2; }
+            out[i] = e;
+        } else if (k > 0 && rank_better(&e, &out[0], bottom)) {
+            out[0] = e;
+            rank_sift_down(out, n, 0, bottom);
+        }
     }
+    /* pop the weakest to the back until the heap is empty: best first */
+    for (int m = n - 1; m > 0; --m) {
+        RankEntry t = out[0]; out[0] = out[m]; out[m] = t;
+        rank_sift_down(out, m, 0, bottom);
+    }
+    return n;
+}
+
+void feature_ranking(void) {
+    int n = table_live_count();
+    if (n == 0) { printf("No records.\n"); return; }
+    printf("Rank by:\n0) Total Marks\n");
+    for (int j = 0; j < SUBJECTS; ++j) printf("%d) %s\n", j + 1, subjectNames[j]);
+    printf("Enter choice: ");
+    int subject, dir, k;
+    if (scanf("%d", &subject) != 1 || subject < 0 || subject > SUBJECTS) { clear_input_line(); printf("Invalid.\n"); return; }
+    clear_input_line();
+    printf("1) Top\n2) Bottom\nEnter choice: ");
+    if (scanf("%d", &dir) != 1 || (dir != 1 && dir != 2)) { clear_input_line(); printf("Invalid.\n"); return; }
+    clear_input_line();
+    printf("How many students: ");
+    if (scanf("%d", &k) != 1 || k <= 0) { clear_input_line(); printf("Invalid.\n"); return; }
+    clear_input_line();
+    if (k > n) k = n;
+    RankEntry *top = malloc((size_t)k * sizeof(RankEntry));
+    if (!top) { printf("Memory error.\n"); return; }
+    int m = rank_top_k(subject - 1, dir == 2, k, top);
+    if (m < 0) { free(top); printf("Memory error.\n"); return; }
+    printf("\n%-5s %-6s %-20s %-8s %-10s %-6s\n", "Rank", "Roll", "Name", subject ? subjectNames[subject - 1] : "Total", "Percent", "Grade");
+    printf("-----------------------------------------------------------\n");
+    int rank = 0;
+    for (int i = 0; i < m; ++i) {
+        /* equal values share a rank: 1, 2, 2, 4 */
+        if (i == 0 || top[i].value != top[i - 1].value) rank = i + 1;
+        const Student *st = &studentTable[top[i].slot];
+        printf("%-5d %-6d %-20s %-8.2f %-10.2f %-6s\n", rank, st->roll, st->name, top[i].value, st->percentage, gradeNames[st->grade]);
+    }
+    free(top);
+}
+
+void feature_statistics(void) {
+    int n = table_live_count();
+    Student *arr = studentTable;
+    if (n == 0) { printf("No records.\n"); return; }
+    /* running totals plus the ends of the percentage index: no row scan */
+    int maxIdx, minIdx;
+    if (!pct_extremes(&minIdx, &maxIdx) || !running_stats_ready()) { printf("Memory error.\n"); return; }
+    const RunningStats *st = &runStats;
+    int pass = st->pass;
     printf("\nTotal Students: %d\nAverage Percentage: %.2f\nHighest: %.2f (%s, Roll %d)\nLowest: %.2f (%s, Roll %d)\nPass Count: %d\nFail Count: %d\n",
-           n, sum / n, arr[maxIdx].percentage, arr[maxIdx].name, arr[maxIdx].roll, arr[minIdx].percentage, arr[minIdx].name, arr[minIdx].roll, pass, n - pass);
-    free(arr);
+           n, st->pctSum / n, arr[maxIdx].percentage, arr[maxIdx].name, arr[maxIdx].roll, arr[minIdx].percentage, arr[minIdx].name, arr[minIdx].roll, pass, n - pass);
+    printf("Grades:");
+    for (int g = 0; g < GRADE_COUNT; ++g) printf(" %s=%d", gradeNames[g], st->gradeCount[g]);
+    printf("\n");
+    printf("\n%-10s %-8s %-8s %-8s %-8s\n", "Subject", "Mean", "Min", "Max", "StdDev");
+    for (int j = 0; j < SUBJECTS; ++j) {
+        double mean = st->sum[j] / n, var = st->sumSq[j] / n - mean * mean;
+        printf("%-10s %-8.2f %-8.2f %-8.2f %-8.2f\n", subjectNames[j], mean, st->min[j], st->max[j], stats_sqrt(var));
+    }
+    size_t live = (size_t)studentCap * (sizeof(Student) + 1) + (size_t)rollIndexCap * sizeof(int);
+    printf("Table Memory: %.1f KB (%.1f bytes/record, peak %.1f bytes/record)\n",
+           live / 1024.0, (double)live / n, (double)(tablePeakBytes + (size_t)rollIndexCap * sizeof(int)) / n);
+    printf("Column Memory: %.1f KB (%.1f bytes/record)\n", cols_bytes() / 1024.0, (double)cols_bytes() / n);
+}
+
+/* ---- Export ---- */
+/* Rows are formatted straight from the resident table into fixed
+   EXPORT_BUF_SIZE buffers that are written out as they fill, so memory use
+   does not grow with the roster and each write hands the OS a large block.
+   Numbers skip printf: integers are converted digit by digit and marks go
+   through fmt_fixed2(), which prints exactly what "%.2f" would.
+
+   Large exports with more than one worker thread are cut into shards of
+   EXPORT_SHARD_ROWS consecutive table slots. Each round, every worker formats
+   one shard's CSV and report rows into buffers of its own while one more
+   thread writes the previous round's shards to the two files in slot order,
+   so both files come out exactly as the sequential export writes them. The
+   table itself is the snapshot: nothing edits it while the menu waits. */
+#define EXPORT_BUF_SIZE (1 << 20)
+/* longest formatted row: a name plus SUBJECTS + 3 numbers and the labels */
+#define EXPORT_ROW_MAX (MAX_NAME + 64 * (SUBJECTS + 4))
+#define EXPORT_SHARD_ROWS 4096
+
+typedef struct {
+    FILE *fp;                     /* NULL: an in-memory shard sized for its rows */
+    char *buf;
+    size_t len, cap;
+    int ok;
+} OutBuf;
+
+static void out_write(OutBuf *o, const char *data, size_t len) {
+    if (len && fwrite(data, 1, len, o->fp) != len) o->ok = 0;
+}
+
+static void out_flush(OutBuf *o) {
+    out_write(o, o->buf, o->len);
+    o->len = 0;
+}
+
+/* Room for at least need bytes at the end of the buffer. */
+static char *out_reserve(OutBuf *o, size_t need) {
+    if (o->fp && o->len + need > o->cap) out_flush(o);
+    return o->buf + o->len;
+}
+
+static char *fmt_str(char *p, const char *s) {
+    size_t n = strlen(s);
+    memcpy(p, s, n);
+    return p + n;
+}
+
+static char *fmt_int(char *p, int v) {
+    char tmp[12];
+    int n = 0;
+    unsigned u = v < 0 ? 0u - (unsigned)v : (unsigned)v;
+    do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+    if (v < 0) *p++ = '-';
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+/* v with two decimals, as printf("%.2f") prints it. A float times 100 is
+   exact in a double, and it is rounded half to even like glibc does on an
+   exact tie; negatives and huge values are left to snprintf. */
+static char *fmt_fixed2(char *p, float v) {
+    double scaled = (double)v * 100.0;
+    if (!(scaled >= 0.0 && scaled < 1e15)) return p + snprintf(p, 64, "%.2f", v);
+    long long c = (long long)scaled;
+    double rest = scaled - (double)c;      /* exact below 2^52 */
+    if (rest > 0.5 || (rest == 0.5 && (c & 1))) c++;
+    long long whole = c / 100;
+    int frac = (int)(c % 100);
+    char tmp[20];
+    int n = 0;
+    do { tmp[n++] = (char)('0' + whole % 10); whole /= 10; } while (whole);
+    while (n) *p++ = tmp[--n];
+    *p++ = '.';
+    *p++ = (char)('0' + frac / 10);
+    *p++ = (char)('0' + frac % 10);
+    return p;
+}
+
+static void export_csv_row(OutBuf *o, const Student *s) {
+    char *p = out_reserve(o, EXPORT_ROW_MAX), *start = p;
+    p = fmt_int(p, s->roll);
+    *p++ = ',';
+    *p++ = '"';
+    p = fmt_str(p, s->name);
+    *p++ = '"';
+    for (int j = 0; j < SUBJECTS; ++j) { *p++ = ','; p = fmt_fixed2(p, s->marks[j]); }
+    *p++ = ',';
+    p = fmt_fixed2(p, s->total);
+    *p++ = ',';
+    p = fmt_fixed2(p, s->percentage);
+    *p++ = ',';
+    p = fmt_str(p, gradeNames[s->grade]);
+    *p++ = '\n';
+    o->len += (size_t)(p - start);
+}
+
+static void export_report_row(OutBuf *o, const Student *s) {
+    char *p = out_reserve(o, EXPORT_ROW_MAX), *start = p;
+    p = fmt_str(p, "Roll: ");
+    p = fmt_int(p, s->roll);
+    p = fmt_str(p, "\nName: ");
+    p = fmt_str(p, s->name);
+    *p++ = '\n';
+    for (int j = 0; j < SUBJECTS; ++j) {
+        p = fmt_str(p, subjectNames[j]);
+        p = fmt_str(p, ": ");
+        p = fmt_fixed2(p, s->marks[j]);
+        *p++ = '\n';
+    }
+    p = fmt_str(p, "Total: ");
+    p = fmt_fixed2(p, s->total);
+    p = fmt_str(p, "\nPercentage: ");
+    p = fmt_fixed2(p, s->percentage);
+    p = fmt_str(p, "\nGrade: ");
+    p = fmt_str(p, gradeNames[s->grade]);
+    p = fmt_str(p, "\n-----------------\n");
+    o->len += (size_t)(p - start);
+}
+
+typedef struct ExportJob {
+    int lo, hi;                   /* format: table slots of this shard */
+    OutBuf csv, rep;              /* format: the shard's rows */
+    struct ExportJob *flush;      /* write: the previous round's shards */
+    int nflush;
+    OutBuf *csvOut, *repOut;      /* write: the export files */
+} ExportJob;
+
+static void *export_worker(void *arg) {
+    ExportJob *job = arg;
+    if (job->flush) {
+        for (int k = 0; k < job->nflush; ++k) {
+            out_write(job->csvOut, job->flush[k].csv.buf, job->flush[k].csv.len);
+            out_write(job->repOut, job->flush[k].rep.buf, job->flush[k].rep.len);
+        }
+        return NULL;
+    }
+    for (int i = job->lo; i < job->hi; ++i) {
+        if (studentDead[i]) continue;
+        export_csv_row(&job->csv, &studentTable[i]);
+        export_report_row(&job->rep, &studentTable[i]);
+    }
+    return NULL;
+}
+
+/* Rows of the table into two (flushed) files on t format threads plus a
+   writer. Two sets of shards alternate: one is formatted while the other is
+   written. Returns 0, having written nothing, if the shards cannot be
+   allocated. */
+static int export_parallel(OutBuf *csv, OutBuf *rep, int t) {
+    static ExportJob sets[2][MAX_WORKERS];
+    size_t shardBytes = (size_t)EXPORT_SHARD_ROWS * EXPORT_ROW_MAX;
+    int ok = 1;
+    for (int s = 0; s < 2; ++s) {
+        for (int k = 0; k < t; ++k) {
+            ExportJob *job = &sets[s][k];
+            memset(job, 0, sizeof(*job));
+            job->csv.buf = malloc(shardBytes);
+            job->rep.buf = malloc(shardBytes);
+            job->csv.cap = job->rep.cap = shardBytes;
+            if (!job->csv.buf || !job->rep.buf) ok = 0;
+        }
+        ExportJob *writer = &sets[s][t];
+        memset(writer, 0, sizeof(*writer));
+        writer->flush = sets[s ^ 1];
+        writer->nflush = t;
+        writer->csvOut = csv;
+        writer->repOut = rep;
+    }
+    if (ok) {
+        int n = studentCount, s = 0, rounds = 0;
+        for (long long base = 0; base < n; base += (long long)t * EXPORT_SHARD_ROWS, s ^= 1, rounds++) {
+            for (int k = 0; k < t; ++k) {
+                long long lo = base + (long long)k * EXPORT_SHARD_ROWS, hi = lo + EXPORT_SHARD_ROWS;
+                sets[s][k].lo = (int)(lo < n ? lo : n);
+                sets[s][k].hi = (int)(hi < n ? hi : n);
+                sets[s][k].csv.len = sets[s][k].rep.len = 0;
+            }
+            /* from the second round on, the writer drains the other set */
+            run_workers(export_worker, sets[s], sizeof(ExportJob), rounds ? t + 1 : t);
+        }
+        if (rounds) export_worker(&sets[s][t]);
+    }
+    for (int s = 0; s < 2; ++s)
+        for (int k = 0; k < t; ++k) { free(sets[s][k].csv.buf); free(sets[s][k].rep.buf); }
+    return ok;
 }
 
 void feature_export(void) {
-    int n;
-    Student *arr = read_all_students(&n);
-    if (!arr || n == 0) { printf("No records to export.\n"); free(arr); return; }
-    FILE *fcsv = fopen(CSV_FILE, "w");
-    FILE *fr = fopen(REPORT_FILE, "w");
-    if (!fcsv || !fr) { printf("Error creating export files.\n"); if (fcsv) fclose(fcsv); if (fr) fclose(fr); free(arr); return; }
-    fprintf(fcsv, "Roll,Name");
-    for (int i = 0; i < SUBJECTS; ++i) fprintf(fcsv, ",%s", subjectNames[i]);
-    fprintf(fcsv, ",Total,Percentage,Grade\n");
-    for (int i = 0; i < n; ++i) {
-        fprintf(fcsv, "%d,\"%s\"", arr[i].roll, arr[i].name);
-        for (int j = 0; j < SUBJECTS; ++j) fprintf(fcsv, ",%.2f", arr[i].marks[j]);
-        fprintf(fcsv, ",%.2f,%.2f,%s\n", arr[i].total, arr[i].percentage, arr[i].grade);
+    int n = studentCount;
+    Student *arr = studentTable;
+    if (table_live_count() == 0) { printf("No records to export.\n"); return; }
+    OutBuf csv = {fopen(CSV_FILE, "w"), malloc(EXPORT_BUF_SIZE), 0, EXPORT_BUF_SIZE, 1};
+    OutBuf rep = {fopen(REPORT_FILE, "w"), malloc(EXPORT_BUF_SIZE), 0, EXPORT_BUF_SIZE, 1};
+    if (!csv.fp || !rep.fp || !csv.buf || !rep.buf) {
+        printf("Error creating export files.\n");
+        if (csv.fp) fclose(csv.fp);
+        if (rep.fp) fclose(rep.fp);
+        free(csv.buf);
+        free(rep.buf);
+        return;
     }
+    char *p = out_reserve(&csv, EXPORT_ROW_MAX), *start = p;
+    p = fmt_str(p, "Roll,Name");
+    for (int i = 0; i < SUBJECTS; ++i) { *p++ = ','; p = fmt_str(p, subjectNames[i]); }
+    p = fmt_str(p, ",Total,Percentage,Grade\n");
+    csv.len += (size_t)(p - start);
     time_t now = time(NULL);
     char *ts = ctime(&now);
     if (!ts) ts = "unknown time\n";
-    fprintf(fr, "Student Report Generated on %s\n\n", ts);
-    for (int i = 0; i < n; ++i) {
-        fprintf(fr, "Roll: %d\nName: %s\n", arr[i].roll, arr[i].name);
-        for (int j = 0; j < SUBJECTS; ++j) fprintf(fr, "%s: %.2f\n", subjectNames[j], arr[i].marks[j]);
-        fprintf(fr, "Total: %.2f\nPercentage: %.2f\nGrade: %s\n-----------------\n", arr[i].total, arr[i].percentage, arr[i].grade);
-    }
-    fclose(fcsv);
-    fclose(fr);
-    printf("Exported to %s and %s\n", CSV_FILE, REPORT_FILE);
-    free(arr);
+    p = out_reserve(&rep, EXPORT_ROW_MAX);
+    rep.len += (size_t)snprintf(p, EXPORT_ROW_MAX, "Student Report Generated on %s\n\n", ts);
+    int t = worker_threads();
+    if (t > MAX_WORKERS - 1) t = MAX_WORKERS - 1; /* one more thread writes */
+    int sharded = 0;
+    if (t > 1 && table_live_count() >= PARALLEL_EXPORT_MIN_ROWS) {
+        out_flush(&csv);
+        out_flush(&rep);
+        sharded = export_parallel(&csv, &rep, t);
+    }
+    if (!sharded) {
+        for (int i = 0; i < n; ++i) {
+            if (studentDead[i]) continue;
+            export_csv_row(&csv, &arr[i]);
+            export_report_row(&rep, &arr[i]);
+        }
+    }
+    out_flush(&csv);
+    out_flush(&rep);
+    int ok = csv.ok && rep.ok;
+    if (fclose(csv.fp) != 0) ok = 0;
+    if (fclose(rep.fp) != 0) ok = 0;
+    free(csv.buf);
+    free(rep.buf);
+    if (ok) printf("Exported to %s and %s\n", CSV_FILE, REPORT_FILE);
+    else printf("Error writing export files.\n");
 }
 
 void feature_backup(void) {
-    FILE *src = fopen(STUDENT_FILE, "r");
-    if (!src) { printf("No data to backup.\n"); return; }
-    FILE *dst = fopen(BACKUP_FILE, "w");
-    if (!dst) { printf("Error creating backup.\n"); fclose(src); return; }
-    char buf[1024];
-    while (fgets(buf, sizeof(buf), src)) fputs(buf, dst);
-    fclose(src); fclose(dst);
-    printf("Backup saved to %s\n", BACKUP_FILE);
+    if (!store_flush()) { printf("Error saving pending changes.\n"); return; }
+    FILE *probe = fopen(student_store_path(), "rb");
+    if (!probe) { printf("No data to backup.\n"); return; }
+    fclose(probe);
+    double start = now_seconds();
+    long long bytes = copy_file_atomic(student_store_path(), student_backup_path());
+    if (bytes < 0) { printf("Error creating backup.\n"); return; }
+    printf("Backup saved to %s: ", student_backup_path());
+    print_copy_rate(bytes, now_seconds() - start);
 }
 
 void feature_restore(void) {
     if (!yesno("Restore from backup? This will overwrite current records.")) { printf("Restore cancelled.\n"); return; }
-    FILE *src = fopen(BACKUP_FILE, "r");
-    if (!src) { printf("Backup file not found.\n"); return; }
-    FILE *dst = fopen(STUDENT_FILE, "w");
-    if (!dst) { printf("Error restoring.\n"); fclose(src); return; }
-    char buf[1024];
-    while (fgets(buf, sizeof(buf), src)) fputs(buf, dst);
-    fclose(src); fclose(dst);
-    printf("Restore complete.\n");
+    store_checkpoint_wait();
+    FILE *probe = fopen(student_backup_path(), "rb");
+    if (!probe) { printf("Backup file not found.\n"); return; }
+    fclose(probe);
+    double start = now_seconds();
+    long long bytes = copy_file_atomic(student_backup_path(), student_store_path());
+    if (bytes < 0) { printf("Error restoring; current records are unchanged.\n"); return; }
+    double secs = now_seconds() - start;
+    journal_reset(); /* pending edits were made against the replaced roster */
+    table_load();
+    printf("Restore complete: ");
+    print_copy_rate(bytes, secs);
 }
 
 void feature_manage_credentials(void) {
@@ -704,10 +4753,35 @@ void feature_toggle_encryption(void) {
     printf("Enter single character key: ");
     keych = (char)getchar();
     clear_input_line();
-    xor_file(STUDENT_FILE, keych);
+    if (!store_flush()) { printf("Error saving pending changes.\n"); return; }
+    xor_file(student_store_path(), keych);
+    table_load();
     printf("XOR applied with key '%c'. (Run again with same key to decrypt)\n", keych);
 }
 
+/* Rewrite the roster in another storage format and switch the session to it.
+   Marks are stored as the same floats in every format, so a text -> binary ->
+   text round trip reproduces the original file. */
+void feature_convert_storage(void) {
+    if (strcmp(currentRole, "ADMIN") != 0) { printf("Only ADMIN can convert storage.\n"); return; }
+    printf("Current storage: %s\nConvert to:\n1) Text\n2) Binary\n3) B+tree\nEnter choice: ", student_store_path());
+    int ch;
+    if (scanf("%d", &ch) != 1) { clear_input_line(); printf("Invalid.\n"); return; }
+    clear_input_line();
+    if (ch < 1 || ch > 3 || ch - 1 == storageFormat) { printf("Cancelled.\n"); return; }
+    int target = ch - 1;
+    if (!store_flush()) { printf("Error saving pending changes.\n"); return; }
+    int keep = storageFormat;
+    storageFormat = target;
+    table_compact();
+    if (!overwrite_students(studentTable, studentCount) || !write_store_format(target)) {
+        storageFormat = keep;
+        printf("Error writing %s.\n", student_store_path());
+        return;
+    }
+    printf("Converted %d records to %s.\n", table_live_count(), student_store_path());
+}
+
 /* ---- Menus & dispatch ---- */
 void main_menu_dispatch(void) {
     if (strcmp(currentRole, "ADMIN") == 0) admin_menu();
@@ -718,7 +4792,7 @@ void main_menu_dispatch(void) {
 }
 
 void common_reports_menu(void) {
-    printf("\n1) Export (CSV & Report)\n2) Backup\n3) Restore\n4) Toggle Encryption (ADMIN only)\n5) Back\nEnter choice: ");
+    printf("\n1) Export (CSV & Report)\n2) Backup\n3) Restore\n4) Toggle Encryption (ADMIN only)\n5) Convert Storage Format (ADMIN only)\n6) Back\nEnter choice: ");
     int c;
     if (scanf("%d", &c) != 1) { clear_input_line(); return; }
     clear_input_line();
@@ -727,6 +4801,7 @@ void common_reports_menu(void) {
         case 2: feature_backup(); break;
         case 3: feature_restore(); break;
         case 4: feature_toggle_encryption(); break;
+        case 5: feature_convert_storage(); break;
         default: return;
     }
 }
@@ -735,7 +4810,7 @@ void admin_menu(void) {
     int ch;
     do {
         clear_screen(); show_banner();
-        printf("ADMIN MENU\n1) Add Student\n2) Display All\n3) Search\n4) Update\n5) Delete\n6) Delete All (Reset)\n7) Sorting\n8) Statistics\n9) Manage Credentials\n10) Reports/Backup\n11) Logout\nChoose: ");
+        printf("ADMIN MENU\n1) Add Student\n2) Display All\n3) Search\n4) Update\n5) Delete\n6) Delete All (Reset)\n7) Sorting\n8) Statistics\n9) Manage Credentials\n10) Reports/Backup\n11) Ranking\n12) Logout\nChoose: ");
         if (scanf("%d", &ch) != 1) { clear_input_line(); ch = -1; }
         clear_input_line();
         switch (ch) {
@@ -749,7 +4824,8 @@ void admin_menu(void) {
             case 8: feature_statistics(); break;
             case 9: feature_manage_credentials(); break;
             case 10: common_reports_menu(); break;
-            case 11: printf("Logging out...\n"); return;
+            case 11: feature_ranking(); break;
+            case 12: printf("Logging out...\n"); return;
             default: printf("Invalid choice.\n");
         }
         pause_and_wait();
@@ -760,7 +4836,7 @@ void staff_menu(void) {
     int ch;
     do {
         clear_screen(); show_banner();
-        printf("STAFF MENU\n1) Display All\n2) Search\n3) Add Student\n4) Update Student\n5) Delete Student\n6) Sorting\n7) Statistics\n8) Reports/Backup\n9) Logout\nChoose: ");
+        printf("STAFF MENU\n1) Display All\n2) Search\n3) Add Student\n4) Update Student\n5) Delete Student\n6) Sorting\n7) Statistics\n8) Reports/Backup\n9) Ranking\n10) Logout\nChoose: ");
         if (scanf("%d", &ch) != 1) { clear_input_line(); ch = -1; }
         clear_input_line();
         switch (ch) {
@@ -772,7 +4848,8 @@ void staff_menu(void) {
             case 6: feature_sorting(); break;
             case 7: feature_statistics(); break;
             case 8: common_reports_menu(); break;
-            case 9: printf("Logging out...\n"); return;
+            case 9: feature_ranking(); break;
+            case 10: printf("Logging out...\n"); return;
             default: printf("Invalid choice.\n");
         }
         pause_and_wait();
@@ -801,7 +4878,8 @@ void principal_menu(void) {
     int ch;
     do {
         clear_screen(); show_banner();
-        printf("PRINCIPAL MENU\n1) Display All\n2) Search\n3) Statistics\n4) Reports/Backup\n5) Logout\nChoose: ");
+        print_dashboard();
+        printf("PRINCIPAL MENU\n1) Display All\n2) Search\n3) Statistics\n4) Reports/Backup\n5) Ranking\n6) Logout\nChoose: ");
         if (scanf("%d", &ch) != 1) { clear_input_line(); ch = -1; }
         clear_input_line();
         switch (ch) {
@@ -809,7 +4887,8 @@ void principal_menu(void) {
             case 2: feature_search(); break;
             case 3: feature_statistics(); break;
             case 4: common_reports_menu(); break;
-            case 5: printf("Logging out...\n"); return;
+            case 5: feature_ranking(); break;
+            case 6: printf("Logging out...\n"); return;
             default: printf("Invalid choice.\n");
         }
         pause_and_wait();
@@ -824,22 +4903,21 @@ void student_menu(void) {
         if (scanf("%d", &ch) != 1) { clear_input_line(); ch = -1; }
         clear_input_line();
         if (ch == 1) {
-            int n;
-            Student *arr = read_all_students(&n);
-            if (!arr || n == 0) { printf("No records.\n"); free(arr); }
+            int n = studentCount;
+            Student *arr = studentTable;
+            if (table_live_count() == 0) printf("No records.\n");
             else {
                 int found = 0;
                 int isnum = 1;
                 for (size_t i = 0; i < strlen(currentUser); ++i)
                     if (!isdigit((unsigned char)currentUser[i])) { isnum = 0; break; }
                 if (isnum) {
-                    int r = atoi(currentUser);
-                    for (int i = 0; i < n; ++i) if (arr[i].roll == r) { display_students_table(&arr[i], 1); found = 1; break; }
+                    int idx = table_find_roll(atoi(currentUser));
+                    if (idx >= 0) { display_students_table(&arr[idx], 1); print_class_rank(idx); found = 1; }
                 } else {
-                    for (int i = 0; i < n; ++i) if (portable_strcasecmp(arr[i].name, currentUser) == 0) { display_students_table(&arr[i], 1); found = 1; break; }
+                    for (int i = 0; i < n; ++i) if (!studentDead[i] && portable_strcasecmp(arr[i].name, currentUser) == 0) { display_students_table(&arr[i], 1); print_class_rank(i); found = 1; break; }
                 }
                 if (!found) printf("No record found for you.\n");
-                free(arr);
             }
         } else if (ch == 2) { printf("Logging out...\n"); return; }
         else printf("Invalid.\n");
@@ -894,11 +4972,15 @@ int main(void) {
     ensure_default_credentials();
     clear_screen();
     printf("Advanced SRMS - Fixed portable version\n");
+    storage_init();
 
     
 
     if (!login_system()) { printf("Exiting...\n"); return 0; }
+    table_load();
     main_menu_dispatch();
+    store_close();
+    table_unload();
 
     printf("Goodbye.\n");
     return 0;